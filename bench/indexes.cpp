@@ -0,0 +1,403 @@
+//
+// Micro-benchmarks of the spatial indexes: build time, memory footprint and radius and KNN search throughput
+//
+
+/*
+ * Every index is built over the same cloud, either a synthetic one or a file read with the usual readers, for each
+ * number of threads and cell size asked for, and searched from a random sample of its points. Times are the median
+ * of the repeats. One CSV row is written per index, cell size, number of threads and radius:
+ *
+ *   cloud, points, index, cell_size, threads, build_s, build_stdev_s, bytes, radius, radius_qps, mean_neighbors,
+ *   k, knn_qps
+ *
+ * The octree has no cell size, and the smart slice is only built (its searches are those of mixed2d), so those
+ * columns are left empty. The cheesemaps are built with PARALLEL when running on more than one thread, grouping their
+ * points by cell on the OpenMP threads.
+ *
+ * mean_neighbors counts the query point itself, which the spheres of the cheesemaps hold. The octree's searches leave
+ * it out, so it is added back to their results.
+ */
+
+#include "TimeWatcher.hpp"
+#include "benchmarking.hpp"
+#include "cheesemap/cheesemap.hpp"
+#include "handlers.hpp"
+#include "octree.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <omp.h>
+#include <random>
+#include <sstream>
+
+namespace
+{
+	const std::vector<std::string> ALL_INDEXES = { "octree",   "dense2d", "dense3d", "csr",  "sparse2d",
+		                                           "sparse3d", "mixed2d", "mixed3d", "smart" };
+
+	struct BenchOptions
+	{
+		fs::path                 inputFile{};            // synthetic cloud if empty
+		std::string              cloud{ "terrain" };     // synthetic cloud (terrain, volume)
+		size_t                   numPoints{ 1000000 };   // of the synthetic cloud
+		double                   density{ 10 };          // of the synthetic cloud, points per m² of its footprint
+		size_t                   numQueries{ 10000 };    // points searched from
+		size_t                   k{ 10 };                // neighbors of the KNN searches
+		size_t                   repeats{ 5 };
+		std::vector<double>      radii{ 0.5, 1, 2, 3 };
+		std::vector<double>      cellSizes{ 0.5, 1, 2, 4 };
+		std::vector<int>         threads{};              // 1 and all of them if empty
+		std::vector<std::string> indexes{ ALL_INDEXES };
+		fs::path                 outputFile{};           // stdout if empty
+	};
+
+	void printBenchHelp()
+	{
+		std::cout
+		    << "Micro-benchmarks of the spatial indexes, written as CSV\n"
+		    << "\t-h  --help\t\tShow this message\n"
+		    << "\t-i  --input <file>\tCloud to index, a synthetic one if not given\n"
+		    << "\t-c  --cloud <type>\tSynthetic cloud: terrain (2.5D, ALS-like) or volume (3D, TLS-like). Default: terrain\n"
+		    << "\t-n  --points <n>\tPoints of the synthetic cloud. Default: 1000000\n"
+		    << "\t-d  --density <d>\tPoints per m² of the synthetic cloud. Default: 10\n"
+		    << "\t-q  --queries <n>\tPoints searched from. Default: 10000\n"
+		    << "\t-k  --knn <k>\t\tNeighbors of the KNN searches. Default: 10\n"
+		    << "\t-R  --repeats <n>\tRepetitions of every measure. Default: 5\n"
+		    << "\t-r  --radii <list>\tComma separated search radii. Default: 0.5,1,2,3\n"
+		    << "\t-s  --cells <list>\tComma separated cell sizes. Default: 0.5,1,2,4\n"
+		    << "\t-t  --threads <list>\tComma separated numbers of threads. Default: 1 and all of them\n"
+		    << "\t-x  --indexes <list>\tComma separated indexes among octree, dense2d, dense3d, csr, sparse2d,\n"
+		    << "\t\t\t\tsparse3d, mixed2d, mixed3d and smart. Default: all of them\n"
+		    << "\t-o  --output <file>\tCSV file, stdout if not given\n";
+	}
+
+	template<typename T>
+	std::vector<T> parseList(const std::string& text)
+	{
+		std::vector<T>     values;
+		std::istringstream in(text);
+		std::string        item;
+		while (std::getline(in, item, ','))
+		{
+			std::istringstream field(item);
+			T                  value;
+			if (!(field >> value))
+			{
+				std::cout << "Invalid list: " << text << "\n";
+				exit(1);
+			}
+			values.push_back(value);
+		}
+		return values;
+	}
+
+	BenchOptions processBenchArgs(int argc, char** argv)
+	{
+		const char* const short_opts  = "hi:c:n:d:q:k:R:r:s:t:x:o:";
+		const option      long_opts[]  = {
+			{ "help", no_argument, nullptr, 'h' },
+			{ "input", required_argument, nullptr, 'i' },
+			{ "cloud", required_argument, nullptr, 'c' },
+			{ "points", required_argument, nullptr, 'n' },
+			{ "density", required_argument, nullptr, 'd' },
+			{ "queries", required_argument, nullptr, 'q' },
+			{ "knn", required_argument, nullptr, 'k' },
+			{ "repeats", required_argument, nullptr, 'R' },
+			{ "radii", required_argument, nullptr, 'r' },
+			{ "cells", required_argument, nullptr, 's' },
+			{ "threads", required_argument, nullptr, 't' },
+			{ "indexes", required_argument, nullptr, 'x' },
+			{ "output", required_argument, nullptr, 'o' },
+			{ nullptr, 0, nullptr, 0 },
+		};
+
+		BenchOptions opts;
+		int          opt;
+		while ((opt = getopt_long(argc, argv, short_opts, long_opts, nullptr)) != -1)
+		{
+			switch (opt)
+			{
+				case 'i':
+					opts.inputFile = fs::path(std::string(optarg));
+					break;
+				case 'c':
+					opts.cloud = std::string(optarg);
+					break;
+				case 'n':
+					opts.numPoints = std::stoul(optarg);
+					break;
+				case 'd':
+					opts.density = std::stod(optarg);
+					break;
+				case 'q':
+					opts.numQueries = std::stoul(optarg);
+					break;
+				case 'k':
+					opts.k = std::stoul(optarg);
+					break;
+				case 'R':
+					opts.repeats = std::max<size_t>(std::stoul(optarg), 1);
+					break;
+				case 'r':
+					opts.radii = parseList<double>(optarg);
+					break;
+				case 's':
+					opts.cellSizes = parseList<double>(optarg);
+					break;
+				case 't':
+					opts.threads = parseList<int>(optarg);
+					break;
+				case 'x':
+					opts.indexes = parseList<std::string>(optarg);
+					break;
+				case 'o':
+					opts.outputFile = fs::path(std::string(optarg));
+					break;
+				case 'h':
+				case '?':
+				default:
+					printBenchHelp();
+					exit(opt == 'h' ? 0 : 1);
+			}
+		}
+
+		for (const auto& index : opts.indexes)
+		{
+			if (std::find(ALL_INDEXES.begin(), ALL_INDEXES.end(), index) == ALL_INDEXES.end())
+			{
+				std::cout << "Unknown index: " << index << "\n";
+				exit(1);
+			}
+		}
+		if (opts.cloud != "terrain" && opts.cloud != "volume")
+		{
+			std::cout << "Unknown synthetic cloud: " << opts.cloud << "\n";
+			exit(1);
+		}
+		if (opts.threads.empty())
+		{
+			opts.threads = { 1 };
+			if (omp_get_max_threads() > 1) { opts.threads.push_back(omp_get_max_threads()); }
+		}
+
+		return opts;
+	}
+
+	/**
+	 * @brief Square cloud of numPoints at the given density. terrain is a smooth ground with a fifth of the points
+	 * scattered up to 15 m above it, like the vegetation of an ALS survey. volume fills 30 m of height uniformly.
+	 */
+	std::vector<Lpoint> syntheticCloud(const std::string& cloud, size_t numPoints, double density)
+	{
+		const double side = std::sqrt(static_cast<double>(numPoints) / density);
+
+		std::mt19937                     gen(42);
+		std::uniform_real_distribution<> xy(0, side);
+		std::uniform_real_distribution<> unit(0, 1);
+		std::normal_distribution<>       noise(0, 0.05);
+
+		std::vector<Lpoint> points;
+		points.reserve(numPoints);
+		for (size_t i = 0; i < numPoints; i++)
+		{
+			const double x = xy(gen), y = xy(gen);
+			double       z;
+			if (cloud == "volume") { z = 30 * unit(gen); }
+			else
+			{
+				z = 5 * std::sin(x / 40) * std::cos(y / 60) + 2 * std::sin(x / 7 + y / 11) + noise(gen);
+				if (unit(gen) < 0.2) { z += 15 * unit(gen); }
+			}
+			points.emplace_back(i, x, y, z);
+		}
+		return points;
+	}
+
+	// the query, a point of the cloud, is always inside
+	size_t radiusSearch(const Octree& octree, const Lpoint& p, double radius)
+	{
+		return octree.searchSphereNeighbors(p, static_cast<float>(radius)).size() + 1;
+	}
+
+	template<typename Map_t>
+	        requires requires(const Map_t& map, const Lpoint& p) { map.query(chs::kernels::Sphere<3>(p, 1.0)); }
+	size_t radiusSearch(const Map_t& map, const Lpoint& p, double radius)
+	{
+		return map.query(chs::kernels::Sphere<3>(p, radius)).size();
+	}
+
+	size_t knnSearch(const Octree& octree, const Lpoint& p, size_t k) { return octree.KNN(p, k, k).size(); }
+
+	template<typename Map_t>
+	        requires requires(const Map_t& map, const Lpoint& p) { map.knn(size_t{ 1 }, p); }
+	size_t knnSearch(const Map_t& map, const Lpoint& p, size_t k)
+	{
+		return map.knn(k, p).size();
+	}
+
+	/**
+	 * @brief Times the search over all the queries with the current number of threads
+	 * @return Queries per second and mean results per query
+	 */
+	template<typename Search>
+	std::pair<double, double> throughput(const std::vector<Lpoint>& queries, size_t repeats, Search&& search)
+	{
+		size_t     found = 0;
+		const auto stats = benchmarking::benchmark(repeats, [&] {
+			found = 0;
+			#pragma omp parallel for schedule(dynamic, 64) reduction(+:found)
+			for (size_t q = 0; q < queries.size(); q++) { found += search(queries[q]); }
+		});
+		return { static_cast<double>(queries.size()) / stats.median(),
+			     static_cast<double>(found) / static_cast<double>(queries.size()) };
+	}
+
+	/**
+	 * @brief Builds the index opts.repeats times and writes one row per radius. Its searches, when it has them, are
+	 * timed on the last build.
+	 * @param prefix First columns of the rows, up to the number of threads
+	 * @param build Returns a new index in a unique_ptr
+	 */
+	template<typename Build>
+	void benchIndex(std::ostream& csv, const BenchOptions& opts, const std::string& prefix,
+	                const std::vector<Lpoint>& queries, Build&& build)
+	{
+		using Index_t = typename std::invoke_result_t<Build&>::element_type;
+
+		benchmarking::Stats<double> buildt;
+		std::unique_ptr<Index_t>    index;
+		for (size_t r = 0; r < opts.repeats; r++)
+		{
+			index.reset(); // neither two of them alive at once nor the release timed
+			TimeWatcher tw;
+			tw.start();
+			index = build();
+			tw.stop();
+			buildt.add_value(tw.getElapsedDecimalSeconds());
+		}
+
+		std::ostringstream built;
+		built << prefix << buildt.median() << "," << buildt.stdev() << "," << index->mem_footprint() << ",";
+
+		std::string knn = ",";
+		if constexpr (requires(const Index_t& i, const Lpoint& p) { knnSearch(i, p, size_t{ 1 }); })
+		{
+			const auto [qps, found] = throughput(queries, opts.repeats, [&](const Lpoint& p) {
+				return knnSearch(*index, p, opts.k);
+			});
+			knn = std::to_string(opts.k) + "," + std::to_string(qps);
+		}
+
+		for (const double radius : opts.radii)
+		{
+			csv << built.str() << radius << ",";
+			if constexpr (requires(const Index_t& i, const Lpoint& p) { radiusSearch(i, p, 1.0); })
+			{
+				const auto [qps, found] = throughput(queries, opts.repeats, [&](const Lpoint& p) {
+					return radiusSearch(*index, p, radius);
+				});
+				csv << qps << "," << found << ",";
+			}
+			else { csv << ",,"; }
+			csv << knn << "\n";
+		}
+		csv.flush();
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	const BenchOptions opts = processBenchArgs(argc, argv);
+
+	std::vector<Lpoint> points = opts.inputFile.empty() ? syntheticCloud(opts.cloud, opts.numPoints, opts.density)
+	                                                    : readPointCloud(opts.inputFile);
+	const std::string   cloudName = opts.inputFile.empty() ? opts.cloud : opts.inputFile.stem().string();
+	if (points.empty())
+	{
+		std::cout << "Empty point cloud\n";
+		exit(1);
+	}
+
+	// Searched from a fixed sample of the points, copied so that the maps reordering them do not change it
+	std::vector<Lpoint> queries;
+	std::mt19937        gen(7);
+	std::uniform_int_distribution<size_t> pick(0, points.size() - 1);
+	for (size_t q = 0; q < opts.numQueries; q++) { queries.push_back(points[pick(gen)]); }
+
+	std::ofstream file;
+	if (!opts.outputFile.empty()) { file.open(opts.outputFile); }
+	std::ostream& csv = opts.outputFile.empty() ? std::cout : file;
+
+	csv << "cloud,points,index,cell_size,threads,build_s,build_stdev_s,bytes,radius,radius_qps,mean_neighbors,k,"
+	       "knn_qps\n";
+
+	for (const int threads : opts.threads)
+	{
+		omp_set_num_threads(threads);
+		const auto flags = threads > 1 ? chs::flags::build::PARALLEL | chs::flags::build::SHRINK_TO_FIT
+		                               : chs::flags::build::SHRINK_TO_FIT;
+
+		for (const auto& name : opts.indexes)
+		{
+			if (name == "octree")
+			{
+				std::clog << "octree, " << threads << " threads\n";
+				const auto prefix = cloudName + "," + std::to_string(points.size()) + ",octree,," +
+				                    std::to_string(threads) + ",";
+				benchIndex(csv, opts, prefix, queries, [&] { return std::make_unique<Octree>(points); });
+				continue;
+			}
+
+			for (const double cell : opts.cellSizes)
+			{
+				std::clog << name << ", cell " << cell << ", " << threads << " threads\n";
+				std::ostringstream prefix;
+				prefix << cloudName << "," << points.size() << "," << name << "," << cell << "," << threads << ",";
+
+				const auto bench = [&](auto&& build) { benchIndex(csv, opts, prefix.str(), queries, build); };
+				if (name == "dense2d")
+				{
+					bench([&] { return std::make_unique<chs::Dense<Lpoint, 2>>(points, cell, flags); });
+				}
+				else if (name == "dense3d")
+				{
+					bench([&] { return std::make_unique<chs::Dense<Lpoint, 3>>(points, cell, flags); });
+				}
+				else if (name == "csr")
+				{
+					bench([&] { return std::make_unique<chs::DenseCSR<Lpoint, 2>>(points, cell, flags); });
+				}
+				else if (name == "sparse2d")
+				{
+					bench([&] { return std::make_unique<chs::Sparse<Lpoint, 2>>(points, cell, flags); });
+				}
+				else if (name == "sparse3d")
+				{
+					bench([&] { return std::make_unique<chs::Sparse<Lpoint, 3>>(points, cell, flags); });
+				}
+				else if (name == "mixed2d")
+				{
+					bench([&] { return std::make_unique<chs::Mixed2D<Lpoint>>(points, cell, flags); });
+				}
+				else if (name == "mixed3d")
+				{
+					bench([&] { return std::make_unique<chs::Mixed3D<Lpoint>>(points, cell, flags); });
+				}
+				else if (name == "smart")
+				{
+					bench([&] {
+						auto slice = std::make_unique<chs::slice::Smart<Lpoint>>(chs::Box::mbb(points), cell);
+						slice->add_points(points, threads > 1);
+						slice->shrink_to_fit();
+						return slice;
+					});
+				}
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -3,67 +3,79 @@
 
 # Executable
 add_executable(${PROJECT_NAME} ${sources})
+set(targets ${PROJECT_NAME})
 
-# Linking libraries
-if (TARGET OpenMP::OpenMP_CXX)
-    target_link_libraries(${PROJECT_NAME}
-            PRIVATE
-            OpenMP::OpenMP_CXX)
+# Micro-benchmarks of the spatial indexes, sharing every source but the main one
+option(BUILD_BENCH "Build the spatial index micro-benchmarks" OFF)
+if (BUILD_BENCH)
+    set(bench_sources ${sources})
+    list(FILTER bench_sources EXCLUDE REGEX "/src/main\\.cpp$")
+    add_executable(${PROJECT_NAME}_bench bench/indexes.cpp ${bench_sources})
+    list(APPEND targets ${PROJECT_NAME}_bench)
 endif ()
 
-if (TARGET MPI::MPI_CXX)
-    target_link_libraries(${PROJECT_NAME}
-            PRIVATE
-            MPI::MPI_CXX)
-endif()
-
-if (TARGET LAPACK::LAPACK)
-        target_link_libraries(${PROJECT_NAME}
-            PRIVATE
-            LAPACK::LAPACK)
-endif()
+# Linking libraries
+foreach (target ${targets})
+    if (TARGET OpenMP::OpenMP_CXX)
+        target_link_libraries(${target}
+                PRIVATE
+                OpenMP::OpenMP_CXX)
+    endif ()
 
-if (TARGET BLAS::BLAS)
-        target_link_libraries(${PROJECT_NAME}
-            PRIVATE
-            BLAS::BLAS)
-endif()
+    if (TARGET MPI::MPI_CXX)
+        target_link_libraries(${target}
+                PRIVATE
+                MPI::MPI_CXX)
+    endif()
 
-if (TARGET armadillo::armadillo AND
-        ARMADILLO_VERSION_MAJOR GREATER 13)
-    target_link_libraries(${PROJECT_NAME}
-            PRIVATE
-            armadillo::armadillo)
-else ()
-    target_link_libraries(${PROJECT_NAME}
-            PRIVATE
-            ${ARMADILLO_LIBRARIES})
-endif ()
+    if (TARGET LAPACK::LAPACK)
+            target_link_libraries(${target}
+                PRIVATE
+                LAPACK::LAPACK)
+    endif()
 
-if (TARGET Eigen3::Eigen)
-    target_link_libraries(${PROJECT_NAME}
-            PRIVATE
-            Eigen3::Eigen)
-else ()
-    target_link_libraries(${PROJECT_NAME}
-            PRIVATE
-            ${EIGEN_LIBRARIES})
-endif ()
+    if (TARGET BLAS::BLAS)
+            target_link_libraries(${target}
+                PRIVATE
+                BLAS::BLAS)
+    endif()
 
-target_link_libraries(${PROJECT_NAME}
-        PRIVATE
-        ${LASLIB_LIBRARIES})
+    if (TARGET armadillo::armadillo AND
+            ARMADILLO_VERSION_MAJOR GREATER 13)
+        target_link_libraries(${target}
+                PRIVATE
+                armadillo::armadillo)
+    else ()
+        target_link_libraries(${target}
+                PRIVATE
+                ${ARMADILLO_LIBRARIES})
+    endif ()
 
-target_link_libraries(${PROJECT_NAME}
-        PRIVATE
-        ${MATHGEOLIB_LIBRARIES})
+    if (TARGET Eigen3::Eigen)
+        target_link_libraries(${target}
+                PRIVATE
+                Eigen3::Eigen)
+    else ()
+        target_link_libraries(${target}
+                PRIVATE
+                ${EIGEN_LIBRARIES})
+    endif ()
 
-if (TARGET range-v3::range-v3)
-    target_link_libraries(${PROJECT_NAME}
+    target_link_libraries(${target}
             PRIVATE
-            range-v3::range-v3)
-else ()
-    target_link_libraries(${PROJECT_NAME}
+            ${LASLIB_LIBRARIES})
+
+    target_link_libraries(${target}
             PRIVATE
-            ${RANGE-V3_LIBRARIES})
-endif ()
+            ${MATHGEOLIB_LIBRARIES})
+
+    if (TARGET range-v3::range-v3)
+        target_link_libraries(${target}
+                PRIVATE
+                range-v3::range-v3)
+    else ()
+        target_link_libraries(${target}
+                PRIVATE
+                ${RANGE-V3_LIBRARIES})
+    endif ()
+endforeach ()
@@ -11,6 +11,17 @@ set(CMAKE_CXX_STANDARD 20)
 # MISC Flags
 #set(CMAKE_CXX_FLAGS "-lstdc++fs")
 
+# Vector instructions of the host, without them the packed kernel tests of the octree stay scalar. Off by default, as
+# the binary would not run on older CPUs than the one it was built on
+option(NATIVE_ARCH "Tune for the CPU of the build host (-march=native)" OFF)
+if (NATIVE_ARCH)
+    include(CheckCXXCompilerFlag)
+    check_cxx_compiler_flag("-march=native" march_native)
+    if (march_native)
+        add_compile_options(-march=native)
+    endif ()
+endif ()
+
 # Enable LTO (Link Time Optimization)
 include(CheckIPOSupported)
 
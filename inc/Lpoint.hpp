@@ -7,6 +7,7 @@
 
 #include "point.hpp"
 #include <array>
+#include <cstdint>
 
 class Region; // Region forward declaration
 
@@ -77,6 +78,9 @@ class Lpoint : public Point
 	inline unsigned short        nor() const { return nor_; }
 	inline unsigned short        dir() const { return dir_; }
 	inline unsigned short        edge() const { return edge_; }
+	inline char                  sar() const { return sar_; }
+	inline unsigned char         ud() const { return ud_; }
+	inline unsigned short        psId() const { return psId_; }
 	inline unsigned int          getR() const { return r_; }
 	inline void                  setR(unsigned int r) { r_ = r; }
 	inline unsigned int          getG() const { return g_; }
@@ -103,7 +107,9 @@ class Lpoint : public Point
 	std::array<double, 2> 	vertMom{};		// vertical moment (x2)
 
 	bool					overlap{false};	// true if points exists in another partition
+	bool					filtered{false};	// outlier, without descriptors and not a neighbor of other points
 	unsigned short			part{};
+	uint64_t				cluster{};		// Euclidean cluster, same for all the partitions holding the point
 };
 
 #endif //RULE_BASED_CLASSIFIER_CPP_LPOINT_HPP
@@ -5,13 +5,10 @@
 #ifndef KERNELFACTORY_HPP
 #define KERNELFACTORY_HPP
 
-#include "KernelCircle.hpp"
-#include "KernelCube.hpp"
-#include "KernelSphere.hpp"
-#include "KernelSquare.hpp"
+#include "cheesemap/kernels/kernels.hpp"
 #include "point.hpp"
 
-#include <memory>
+#include <utility>
 
 enum class Kernel_t // Different types of kernels to be used in the factory function
 {
@@ -21,22 +18,41 @@ enum class Kernel_t // Different types of kernels to be used in the factory func
 	cube
 };
 
-template<Kernel_t kernel_type>
-inline auto kernelFactory_ptr(const Point& center, const double radius) -> std::unique_ptr<KernelAbstract>
+// A cheesemap kernel that keeps the point it is centered on, id included, so that searches can leave that point out
+template<class Kernel>
+class CenteredKernel : public Kernel
 {
-	if constexpr (kernel_type == Kernel_t::circle) { return std::make_unique<KernelCircle>(center, radius); }
-	else if constexpr (kernel_type == Kernel_t::square) { return std::make_unique<KernelSquare>(center, radius); }
-	else if constexpr (kernel_type == Kernel_t::sphere) { return std::make_unique<KernelSphere>(center, radius); }
-	else /* if constexpr (kernel_type == Kernel_t::cube) */ { return std::make_unique<KernelCube>(center, radius); }
-}
+	Point center_;
+
+	public:
+	template<class... Args>
+	CenteredKernel(const Point& center, Args&&... args) : Kernel(center, std::forward<Args>(args)...), center_(center)
+	{}
+
+	[[nodiscard]] inline auto center() const -> const Point& { return center_; }
+};
 
+// The octree searches with the cheesemap kernels: circles and squares are their 2D versions, which ignore z. They are
+// open, as the octree's kernels always were, so points exactly on the boundary are not neighbours
 template<Kernel_t kernel_type>
 inline auto kernelFactory(const Point& center, const double radius)
 {
-	if constexpr (kernel_type == Kernel_t::circle) { return KernelCircle(center, radius); }
-	else if constexpr (kernel_type == Kernel_t::square) { return KernelSquare(center, radius); }
-	else if constexpr (kernel_type == Kernel_t::sphere) { return KernelSphere(center, radius); }
-	else /* if constexpr (kernel_type == Kernel_t::cube) */ { return KernelCube(center, radius); }
+	if constexpr (kernel_type == Kernel_t::circle)
+	{
+		return CenteredKernel<chs::kernels::Sphere<2, false>>(center, radius);
+	}
+	else if constexpr (kernel_type == Kernel_t::square)
+	{
+		return CenteredKernel<chs::kernels::Cube<2, false>>(center, radius);
+	}
+	else if constexpr (kernel_type == Kernel_t::sphere)
+	{
+		return CenteredKernel<chs::kernels::Sphere<3, false>>(center, radius);
+	}
+	else /* if constexpr (kernel_type == Kernel_t::cube) */
+	{
+		return CenteredKernel<chs::kernels::Cube<3, false>>(center, radius);
+	}
 }
 
 template<Kernel_t kernel_type>
@@ -46,8 +62,14 @@ inline auto kernelFactory(const Point& center, const Vector& radii)
 	constexpr bool valid_kernel_type = (kernel_type == Kernel_t::square) || (kernel_type == Kernel_t::cube);
 	static_assert(valid_kernel_type, "Incorrect kernel type");
 
-	if constexpr (kernel_type == Kernel_t::square) { return KernelSquare(center, radii); }
-	else if constexpr (kernel_type == Kernel_t::cube) { return KernelCube(center, radii); }
+	if constexpr (kernel_type == Kernel_t::square)
+	{
+		return CenteredKernel<chs::kernels::Cube<2, false>>(center, radii);
+	}
+	else if constexpr (kernel_type == Kernel_t::cube)
+	{
+		return CenteredKernel<chs::kernels::Cube<3, false>>(center, radii);
+	}
 }
 
 #endif /* end of include guard: KERNELFACTORY_HPP */
@@ -2,4 +2,6 @@
 
 #include "maps/maps.hpp"
 
-#include "kernels/kernels.hpp"
\ No newline at end of file
+#include "kernels/kernels.hpp"
+
+#include "utils/arena.hpp"
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
+#include <vector>
 
 #include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/packed.hpp"
+#include "cheesemap/utils/Position.hpp"
 
 namespace chs::concepts
 {
@@ -21,4 +25,44 @@ namespace chs::concepts
 			kernel.box()
 		} -> std::convertible_to<const chs::Box &>;
 	};
+
+	/**
+	 * @brief A kernel that can tell whether a whole box lies outside, inside or across it, so that maps can skip
+	 * or take whole cells instead of testing their points.
+	 */
+	template<typename Kernel_type, typename Point_type>
+	concept ClassifyingKernel = Kernel<Kernel_type, Point_type> and requires(const Kernel_type & kernel,
+	                                                                         const chs::Box & box) {
+		{
+			kernel.classify(box)
+		} -> std::convertible_to<chs::Position>;
+	};
+
+	/**
+	 * @brief A kernel that can test a run of packed points at once, writing whether each of them is inside
+	 */
+	template<typename Kernel_type, typename Point_type>
+	concept PackedKernel = Kernel<Kernel_type, Point_type> and requires(const Kernel_type & kernel,
+	                                                                    const chs::PackedPoints & points,
+	                                                                    std::uint8_t * inside) {
+		kernel.is_inside(points, inside);
+	};
+
+	/**
+	 * @brief A kernel whose points all lie within the height of its box, so that maps with columns sorted by height
+	 * may skip the points above and below it. Kernels over the first two axes take points at any height, even if
+	 * their box is a cube around the center.
+	 */
+	template<typename Kernel_type>
+	concept HeightBoundedKernel = requires { requires Kernel_type::bounds_height; };
+
+	/**
+	 * @brief A kernel that narrows down the points found inside it, e.g. to the closest ones, once a map has gathered
+	 * them all
+	 */
+	template<typename Kernel_type, typename Point_type>
+	concept SelectingKernel = Kernel<Kernel_type, Point_type> and requires(const Kernel_type & kernel,
+	                                                                       std::vector<Point_type *> & points) {
+		kernel.select(points);
+	};
 } // namespace chs::concepts
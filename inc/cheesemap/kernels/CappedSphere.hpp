@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "cheesemap/concepts/Kernel.hpp"
+#include "cheesemap/kernels/Sphere.hpp"
+
+#include "cheesemap/utils/arithmetic.hpp"
+#include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/packed.hpp"
+#include "cheesemap/utils/Point.hpp"
+#include "cheesemap/utils/Position.hpp"
+
+namespace chs::kernels
+{
+	/**
+	 * @brief Sphere keeping at most its k points closest to the center. Maps gather the points of the sphere as usual
+	 * and then call select() on them, which keeps the k closest, from the closest to the farthest. Open or closed as
+	 * its sphere.
+	 */
+	template<std::size_t Dim = 3, bool Closed = true>
+	class CappedSphere
+	{
+		Sphere<Dim, Closed> sphere_;
+		std::size_t k_{};
+
+		public:
+		static constexpr bool bounds_height = Dim >= 3;
+
+		CappedSphere() = delete;
+		CappedSphere(const Point & center, const double radius, const std::size_t k) : sphere_(center, radius), k_(k) {}
+
+		[[nodiscard]] inline auto center() const -> const Point & { return sphere_.center(); }
+		[[nodiscard]] inline auto radius() const -> double { return sphere_.radius(); }
+		[[nodiscard]] inline auto k() const -> std::size_t { return k_; }
+		[[nodiscard]] inline auto box() const -> const Box & { return sphere_.box(); }
+
+		[[nodiscard]] inline auto is_inside(const Point & p) const -> bool { return sphere_.is_inside(p); }
+
+		inline void is_inside(const PackedPoints & points, std::uint8_t * inside) const
+		{
+			sphere_.is_inside(points, inside);
+		}
+
+		[[nodiscard]] inline auto classify(const Box & box) const -> Position { return sphere_.classify(box); }
+
+		template<typename Point_type>
+		inline void select(std::vector<Point_type *> & points) const
+		{
+			const auto closer = [&](const Point_type * a, const Point_type * b) {
+				return chs::sq_distance<Dim>(center(), *a) < chs::sq_distance<Dim>(center(), *b);
+			};
+
+			if (points.size() > k_)
+			{
+				std::nth_element(points.begin(), points.begin() + static_cast<std::ptrdiff_t>(k_), points.end(), closer);
+				points.resize(k_);
+			}
+			std::sort(points.begin(), points.end(), closer);
+		}
+	};
+} // namespace chs::kernels
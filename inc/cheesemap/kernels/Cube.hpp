@@ -1,15 +1,21 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 
 #include "cheesemap/concepts/Kernel.hpp"
 
+#include "cheesemap/utils/arithmetic.hpp"
 #include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/packed.hpp"
 #include "cheesemap/utils/Point.hpp"
+#include "cheesemap/utils/Position.hpp"
 
 namespace chs::kernels
 {
-	template<std::size_t Dim = 3>
+	// Closed cubes hold the points on their faces, open ones (Closed = false) leave them out
+	template<std::size_t Dim = 3, bool Closed = true>
 	class Cube
 	{
 		chs::Point center_{};
@@ -22,17 +28,26 @@ namespace chs::kernels
 			bool inside = true;
 
 			// This is a fold expression: inside = \forall_i (box.min()[i] <= p[i] <= box.max()[i])
-			((inside &= box_.min()[Is] <= p[Is] and p[Is] <= box_.max()[Is]), ...);
+			((inside &= chs::within<Closed>(box_.min()[Is], p[Is]) and
+			            chs::within<Closed>(p[Is], box_.max()[Is])),
+			 ...);
 
 			return inside;
 		}
 
 		public:
+		static constexpr bool bounds_height = Dim >= 3;
+
 		Cube() = delete;
 		Cube(const Point & center, const double radius) :
 		        center_(center), radius_(radius), box_(center_, radius_)
 		{}
 
+		// A box with its own half side per axis, radius() being the largest
+		Cube(const Point & center, const Point & radii) :
+		        center_(center), radius_(std::max({ radii[0], radii[1], radii[2] })), box_(center_, radii)
+		{}
+
 		[[nodiscard]] inline auto center() const -> const Point & { return center_; }
 		[[nodiscard]] inline auto radius() const -> double { return radius_; }
 		[[nodiscard]] inline auto box() const -> const Box & { return box_; }
@@ -41,5 +56,42 @@ namespace chs::kernels
 		{
 			return is_inside(p, std::make_index_sequence<Dim>{});
 		}
+
+		/**
+		 * @brief Same test as is_inside(p) for every point of the run, inside[i] being 1 for those in the kernel
+		 */
+		inline void is_inside(const PackedPoints & points, std::uint8_t * inside) const
+		{
+			// Axes and bounds unpacked into locals, so that the loop has nothing left to load but the coordinates
+			[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+				const std::array<const double *, Dim> axes{ points.axes[Is]... };
+				const std::array<double, Dim>         min{ box_.min()[Is]... };
+				const std::array<double, Dim>         max{ box_.max()[Is]... };
+				#pragma omp simd
+				for (std::size_t i = 0; i < points.size; i++)
+				{
+					// Bitwise and, as branches would keep the loop from being vectorized
+					inside[i] = ((chs::within<Closed>(min[Is], axes[Is][i]) &
+					              chs::within<Closed>(axes[Is][i], max[Is])) &
+					             ...);
+				}
+			}(std::make_index_sequence<Dim>{});
+		}
+
+		[[nodiscard]] inline auto classify(const Box & box) const -> Position
+		{
+			bool inside = true;
+			for (std::size_t i = 0; i < Dim; i++)
+			{
+				if (not chs::within<Closed>(box_.min()[i], box.max()[i]) or
+				    not chs::within<Closed>(box.min()[i], box_.max()[i]))
+				{
+					return Position::OUTSIDE;
+				}
+				inside = inside and chs::within<Closed>(box_.min()[i], box.min()[i]) and
+				         chs::within<Closed>(box.max()[i], box_.max()[i]);
+			}
+			return inside ? Position::INSIDE : Position::PARTIAL;
+		}
 	};
 } // namespace chs::kernels
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "cheesemap/concepts/Kernel.hpp"
+
+#include "cheesemap/utils/arithmetic.hpp"
+#include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/packed.hpp"
+#include "cheesemap/utils/Point.hpp"
+#include "cheesemap/utils/Position.hpp"
+
+namespace chs::kernels
+{
+	/**
+	 * @brief Vertical cylinder: the points within radius of the center in x and y, with z between z_min and z_max.
+	 * Closed cylinders hold the points on their side, open ones (Closed = false) leave them out. Both hold the points
+	 * at z_min and z_max.
+	 */
+	template<bool Closed = true>
+	class Cylinder
+	{
+		chs::Point center_{};
+		double     radius_{};
+		double     sq_radius_{};
+		double     z_min_{};
+		double     z_max_{};
+		chs::Box   box_;
+
+		public:
+		static constexpr bool bounds_height = true;
+
+		Cylinder() = delete;
+		Cylinder(const Point & center, const double radius, const double z_min, const double z_max) :
+		        center_(center),
+		        radius_(radius),
+		        sq_radius_(radius * radius),
+		        z_min_(z_min),
+		        z_max_(z_max),
+		        box_(std::pair{ Point{ center[0] - radius, center[1] - radius, z_min },
+		                        Point{ center[0] + radius, center[1] + radius, z_max } })
+		{}
+
+		[[nodiscard]] inline auto center() const -> const Point & { return center_; }
+		[[nodiscard]] inline auto radius() const -> double { return radius_; }
+		[[nodiscard]] inline auto z_min() const -> double { return z_min_; }
+		[[nodiscard]] inline auto z_max() const -> double { return z_max_; }
+		[[nodiscard]] inline auto box() const -> const Box & { return box_; }
+
+		[[nodiscard]] inline auto is_inside(const Point & p) const -> bool
+		{
+			return z_min_ <= p[2] and p[2] <= z_max_ and
+			       chs::within<Closed>(chs::sq_distance<2>(center_, p), sq_radius_);
+		}
+
+		/**
+		 * @brief Same test as is_inside(p) for every point of the run, inside[i] being 1 for those in the kernel
+		 */
+		inline void is_inside(const PackedPoints & points, std::uint8_t * inside) const
+		{
+			const double * x  = points.axes[0];
+			const double * y  = points.axes[1];
+			const double * z  = points.axes[2];
+			const double   cx = center_[0];
+			const double   cy = center_[1];
+			#pragma omp simd
+			for (std::size_t i = 0; i < points.size; i++)
+			{
+				const double sq_distance = (x[i] - cx) * (x[i] - cx) + (y[i] - cy) * (y[i] - cy);
+				inside[i] = chs::within<Closed>(sq_distance, sq_radius_) & (z_min_ <= z[i]) & (z[i] <= z_max_);
+			}
+		}
+
+		[[nodiscard]] inline auto classify(const Box & box) const -> Position
+		{
+			if (box.max()[2] < z_min_ or z_max_ < box.min()[2]) { return Position::OUTSIDE; }
+
+			const auto [near, far] = box.sq_distance_range<2>(center_);
+			if (not chs::within<Closed>(near, sq_radius_)) { return Position::OUTSIDE; }
+			if (chs::within<Closed>(far, sq_radius_) and z_min_ <= box.min()[2] and box.max()[2] <= z_max_)
+			{
+				return Position::INSIDE;
+			}
+			return Position::PARTIAL;
+		}
+	};
+} // namespace chs::kernels
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include "cheesemap/concepts/Kernel.hpp"
+
+#include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/packed.hpp"
+#include "cheesemap/utils/Point.hpp"
+#include "cheesemap/utils/Position.hpp"
+
+namespace chs::kernels
+{
+	/**
+	 * @brief Box with its own orthonormal axes: the points whose offset from the center, projected on axis j, is
+	 * at most half_extents[j] in absolute value. Its box() is the axis-aligned box around it.
+	 */
+	class OrientedBox
+	{
+		chs::Point                center_{};
+		std::array<chs::Point, 3> axes_{};
+		chs::Point                half_extents_{};
+		chs::Box                  box_;
+
+		[[nodiscard]] static inline auto dot(const Point & a, const Point & b) -> double
+		{
+			return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+		}
+
+		// Half side along world axis i of the axis-aligned box around a box with these axes and half extents
+		[[nodiscard]] static inline auto reach(const std::array<Point, 3> & axes, const Point & half_extents,
+		                                       const std::size_t i) -> double
+		{
+			return std::abs(axes[0][i]) * half_extents[0] + std::abs(axes[1][i]) * half_extents[1] +
+			       std::abs(axes[2][i]) * half_extents[2];
+		}
+
+		[[nodiscard]] static inline auto bounds(const Point & center, const std::array<Point, 3> & axes,
+		                                        const Point & half_extents) -> Box
+		{
+			return Box(center, Point{ reach(axes, half_extents, 0), reach(axes, half_extents, 1),
+			                          reach(axes, half_extents, 2) });
+		}
+
+		public:
+		static constexpr bool bounds_height = true;
+
+		OrientedBox() = delete;
+		OrientedBox(const Point & center, const std::array<Point, 3> & axes, const Point & half_extents) :
+		        center_(center), axes_(axes), half_extents_(half_extents), box_(bounds(center, axes, half_extents))
+		{}
+
+		/**
+		 * @brief Box turned yaw radians around the vertical axis, e.g. aligned with a road or a building facade
+		 */
+		OrientedBox(const Point & center, const Point & half_extents, const double yaw) :
+		        OrientedBox(center,
+		                    { Point{ std::cos(yaw), std::sin(yaw), 0.0 }, Point{ -std::sin(yaw), std::cos(yaw), 0.0 },
+		                      Point{ 0.0, 0.0, 1.0 } },
+		                    half_extents)
+		{}
+
+		[[nodiscard]] inline auto center() const -> const Point & { return center_; }
+		[[nodiscard]] inline auto axes() const -> const std::array<Point, 3> & { return axes_; }
+		[[nodiscard]] inline auto half_extents() const -> const Point & { return half_extents_; }
+		[[nodiscard]] inline auto box() const -> const Box & { return box_; }
+
+		[[nodiscard]] inline auto is_inside(const Point & p) const -> bool
+		{
+			const Point offset{ p[0] - center_[0], p[1] - center_[1], p[2] - center_[2] };
+			return std::abs(dot(offset, axes_[0])) <= half_extents_[0] and
+			       std::abs(dot(offset, axes_[1])) <= half_extents_[1] and
+			       std::abs(dot(offset, axes_[2])) <= half_extents_[2];
+		}
+
+		/**
+		 * @brief Same test as is_inside(p) for every point of the run, inside[i] being 1 for those in the kernel
+		 */
+		inline void is_inside(const PackedPoints & points, std::uint8_t * inside) const
+		{
+			const double * x = points.axes[0];
+			const double * y = points.axes[1];
+			const double * z = points.axes[2];
+			const double   c[3]{ center_[0], center_[1], center_[2] };
+			const double   a[3][3]{ { axes_[0][0], axes_[0][1], axes_[0][2] },
+			                        { axes_[1][0], axes_[1][1], axes_[1][2] },
+			                        { axes_[2][0], axes_[2][1], axes_[2][2] } };
+			const double   h[3]{ half_extents_[0], half_extents_[1], half_extents_[2] };
+			#pragma omp simd
+			for (std::size_t i = 0; i < points.size; i++)
+			{
+				const double dx = x[i] - c[0];
+				const double dy = y[i] - c[1];
+				const double dz = z[i] - c[2];
+				inside[i]       = (std::abs(a[0][0] * dx + a[0][1] * dy + a[0][2] * dz) <= h[0]) &
+				            (std::abs(a[1][0] * dx + a[1][1] * dy + a[1][2] * dz) <= h[1]) &
+				            (std::abs(a[2][0] * dx + a[2][1] * dy + a[2][2] * dz) <= h[2]);
+			}
+		}
+
+		/**
+		 * @brief Separating axis test on the faces of both boxes. Boxes only separated along an edge direction are
+		 * reported as PARTIAL, which costs testing their points but never loses any.
+		 */
+		[[nodiscard]] inline auto classify(const Box & box) const -> Position
+		{
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				if (box.max()[i] < box_.min()[i] or box_.max()[i] < box.min()[i]) { return Position::OUTSIDE; }
+			}
+
+			const Point offset{ (box.min()[0] + box.max()[0]) / 2 - center_[0],
+				                (box.min()[1] + box.max()[1]) / 2 - center_[1],
+				                (box.min()[2] + box.max()[2]) / 2 - center_[2] };
+			const Point half{ (box.max()[0] - box.min()[0]) / 2, (box.max()[1] - box.min()[1]) / 2,
+				              (box.max()[2] - box.min()[2]) / 2 };
+
+			bool inside = true;
+			for (std::size_t j = 0; j < 3; j++)
+			{
+				// Projections on axis j of the center of the box and of its half diagonal
+				const auto center = std::abs(dot(offset, axes_[j]));
+				const auto extent = std::abs(axes_[j][0]) * half[0] + std::abs(axes_[j][1]) * half[1] +
+				                    std::abs(axes_[j][2]) * half[2];
+				if (center - extent > half_extents_[j]) { return Position::OUTSIDE; }
+				inside = inside and center + extent <= half_extents_[j];
+			}
+			return inside ? Position::INSIDE : Position::PARTIAL;
+		}
+	};
+} // namespace chs::kernels
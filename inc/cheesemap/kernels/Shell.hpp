@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "cheesemap/concepts/Kernel.hpp"
+
+#include "cheesemap/utils/arithmetic.hpp"
+#include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/packed.hpp"
+#include "cheesemap/utils/Point.hpp"
+#include "cheesemap/utils/Position.hpp"
+
+namespace chs::kernels
+{
+	/**
+	 * @brief Spherical shell: the points at least inner and at most outer away from the center. With Dim = 2 it is
+	 * an annulus, distances being measured in x and y only. Closed shells hold the points on both of their spheres,
+	 * open ones (Closed = false) leave them out.
+	 */
+	template<std::size_t Dim = 3, bool Closed = true>
+	class Shell
+	{
+		chs::Point center_{};
+		double     inner_{};
+		double     outer_{};
+		double     sq_inner_{};
+		double     sq_outer_{};
+		chs::Box   box_;
+
+		public:
+		static constexpr bool bounds_height = Dim >= 3;
+
+		Shell() = delete;
+		Shell(const Point & center, const double inner, const double outer) :
+		        center_(center),
+		        inner_(inner),
+		        outer_(outer),
+		        sq_inner_(inner * inner),
+		        sq_outer_(outer * outer),
+		        box_(center_, outer_)
+		{}
+
+		[[nodiscard]] inline auto center() const -> const Point & { return center_; }
+		[[nodiscard]] inline auto inner() const -> double { return inner_; }
+		[[nodiscard]] inline auto outer() const -> double { return outer_; }
+		[[nodiscard]] inline auto box() const -> const Box & { return box_; }
+
+		[[nodiscard]] inline auto is_inside(const Point & p) const -> bool
+		{
+			const auto sq_distance = chs::sq_distance<Dim>(center_, p);
+			return chs::within<Closed>(sq_inner_, sq_distance) and chs::within<Closed>(sq_distance, sq_outer_);
+		}
+
+		/**
+		 * @brief Same test as is_inside(p) for every point of the run, inside[i] being 1 for those in the kernel
+		 */
+		inline void is_inside(const PackedPoints & points, std::uint8_t * inside) const
+		{
+			[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+				const std::array<const double *, Dim> axes{ points.axes[Is]... };
+				const std::array<double, Dim>         c{ center_[Is]... };
+				#pragma omp simd
+				for (std::size_t i = 0; i < points.size; i++)
+				{
+					const double sq_distance = (((axes[Is][i] - c[Is]) * (axes[Is][i] - c[Is])) + ...);
+					inside[i]                = chs::within<Closed>(sq_inner_, sq_distance) &
+					                           chs::within<Closed>(sq_distance, sq_outer_);
+				}
+			}(std::make_index_sequence<Dim>{});
+		}
+
+		[[nodiscard]] inline auto classify(const Box & box) const -> Position
+		{
+			// Outside if the box is beyond the outer sphere or within the inner one
+			const auto [near, far] = box.sq_distance_range<Dim>(center_);
+			if (not chs::within<Closed>(near, sq_outer_) or not chs::within<Closed>(sq_inner_, far))
+			{
+				return Position::OUTSIDE;
+			}
+			if (chs::within<Closed>(sq_inner_, near) and chs::within<Closed>(far, sq_outer_))
+			{
+				return Position::INSIDE;
+			}
+			return Position::PARTIAL;
+		}
+	};
+} // namespace chs::kernels
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
 #include <range/v3/numeric/accumulate.hpp>
 #include <range/v3/view/indices.hpp>
 #include <range/v3/view/transform.hpp>
@@ -8,11 +12,14 @@
 
 #include "cheesemap/utils/arithmetic.hpp"
 #include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/packed.hpp"
 #include "cheesemap/utils/Point.hpp"
+#include "cheesemap/utils/Position.hpp"
 
 namespace chs::kernels
 {
-	template<std::size_t Dim = 3>
+	// Closed spheres hold the points at exactly their radius, open ones (Closed = false) leave them out
+	template<std::size_t Dim = 3, bool Closed = true>
 	class Sphere
 	{
 		chs::Point center_{};
@@ -21,6 +28,8 @@ namespace chs::kernels
 		chs::Box   box_;
 
 		public:
+		static constexpr bool bounds_height = Dim >= 3;
+
 		Sphere() = delete;
 		Sphere(const Point & center, const double radius) :
 		        center_(center), radius_(radius), sq_radius_(radius * radius), box_(center_, radius_)
@@ -32,7 +41,33 @@ namespace chs::kernels
 
 		[[nodiscard]] inline auto is_inside(const Point & p) const -> bool
 		{
-			return chs::sq_distance<Dim>(center_, p) <= sq_radius_;
+			return chs::within<Closed>(chs::sq_distance<Dim>(center_, p), sq_radius_);
+		}
+
+		/**
+		 * @brief Same test as is_inside(p) for every point of the run, inside[i] being 1 for those in the kernel
+		 */
+		inline void is_inside(const PackedPoints & points, std::uint8_t * inside) const
+		{
+			// Axes and center unpacked into locals, so that the loop has nothing left to load but the coordinates
+			[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+				const std::array<const double *, Dim> axes{ points.axes[Is]... };
+				const std::array<double, Dim>         c{ center_[Is]... };
+				#pragma omp simd
+				for (std::size_t i = 0; i < points.size; i++)
+				{
+					const double sq_distance = (((axes[Is][i] - c[Is]) * (axes[Is][i] - c[Is])) + ...);
+					inside[i]                = chs::within<Closed>(sq_distance, sq_radius_);
+				}
+			}(std::make_index_sequence<Dim>{});
+		}
+
+		[[nodiscard]] inline auto classify(const Box & box) const -> Position
+		{
+			const auto [near, far] = box.sq_distance_range<Dim>(center_);
+			if (not chs::within<Closed>(near, sq_radius_)) { return Position::OUTSIDE; }
+			if (chs::within<Closed>(far, sq_radius_)) { return Position::INSIDE; }
+			return Position::PARTIAL;
 		}
 	};
 } // namespace chs::kernels
\ No newline at end of file
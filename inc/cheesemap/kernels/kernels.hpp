@@ -1,4 +1,8 @@
 #pragma once
 
+#include "CappedSphere.hpp"
 #include "Cube.hpp"
-#include "Sphere.hpp"
\ No newline at end of file
+#include "Cylinder.hpp"
+#include "OrientedBox.hpp"
+#include "Shell.hpp"
+#include "Sphere.hpp"
@@ -2,6 +2,8 @@
 
 #include <array>
 #include <execution>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -12,23 +14,33 @@
 
 #include "cheesemap/utils/Box.hpp"
 #include "cheesemap/utils/Cell.hpp"
-#include "cheesemap/utils/sorted_vector.hpp"
+#include "cheesemap/utils/Position.hpp"
+#include "cheesemap/utils/knn.hpp"
+#include "cheesemap/utils/stats.hpp"
 
 #include "cheesemap/utils/arithmetic.hpp"
+#include "cheesemap/utils/bucketing.hpp"
 #include "cheesemap/utils/Cartesian.hpp"
 #include "cheesemap/utils/flags.hpp"
 #include "cheesemap/utils/type_traits.hpp"
+#include "cheesemap/utils/updates.hpp"
+#include "cheesemap/utils/zsort.hpp"
 
 namespace chs
 {
-	template<typename Point_type, std::size_t Dim = 3>
+	/**
+	 * @brief Dense grid with a vector of points per cell. Cells and the table of cells are allocated with
+	 * Allocator_type, e.g. a std::pmr::polymorphic_allocator over a chs::Arena to skip malloc for every cell.
+	 */
+	template<typename Point_type, std::size_t Dim = 3, typename Allocator_type = std::allocator<Point_type *>>
 	class Dense
 	{
 		protected:
 		using resolution_type = double;
 		using dimensions_type = chs::type_traits::tuple<resolution_type, Dim>;
 		using indices_type    = chs::type_traits::tuple<std::size_t, Dim>;
-		using cell_type       = Cell<Point_type>;
+		using cell_type       = Cell<Point_type, Allocator_type>;
+		using cells_allocator = typename std::allocator_traits<Allocator_type>::template rebind_alloc<cell_type>;
 
 		static constexpr dimensions_type DEFAULT_RESOLUTIONS = chs::n_tuple<Dim>(resolution_type{ 1 });
 
@@ -42,7 +54,13 @@ namespace chs
 		indices_type sizes_;
 
 		// Cells of the map
-		std::vector<cell_type> cells_;
+		std::vector<cell_type, cells_allocator> cells_;
+
+		// Points of each cell sorted by z (SORT_Z)
+		bool sorted_z_{};
+
+		// Slot of every point in its cell (DYNAMIC)
+		std::optional<PointSlots<Point_type>> slots_;
 
 		template<std::size_t... Is>
 		[[nodiscard]] inline auto indices2global(const auto & indices, std::index_sequence<Is...>) const
@@ -102,17 +120,167 @@ namespace chs
 
 		[[nodiscard]] inline auto & at(const auto & indices) const { return cells_[indices2global(indices)]; }
 
+		// Adds the points of the cell inside the kernel that pass the filter, only testing them if it is PARTIAL
+		inline void collect(const auto & indices, const Position position, const auto & kernel, auto && filter,
+		                    std::vector<Point_type *> & points) const
+		{
+			if (position == Position::OUTSIDE) { return; }
+
+			const auto & cell        = at(indices);
+			const auto [first, last] = sorted_z_ and chs::bounds_z<decltype(kernel)>
+			                                   ? chs::z_range(cell.begin(), cell.end(), kernel.box().min()[2],
+			                                                  kernel.box().max()[2])
+			                                   : std::pair{ cell.begin(), cell.end() };
+			for (const auto & point : ranges::subrange(first, last))
+			{
+				if ((position == Position::INSIDE or kernel.is_inside(*point)) and filter(*point))
+				{
+					points.emplace_back(point);
+				}
+			}
+		}
+
+		// With SORT_Z, sorts the points of every cell by height. Only for 2D maps, whose cells span the whole height
+		inline void sort_cells_z(const chs::flags::build::flags_t flags)
+		{
+			if constexpr (Dim == 2)
+			{
+				if (not(flags & chs::flags::build::SORT_Z)) { return; }
+
+				#pragma omp parallel for schedule(dynamic, 256) if (flags & chs::flags::build::PARALLEL)
+				for (std::size_t c = 0; c < cells_.size(); c++) { chs::sort_z(cells_[c].begin(), cells_[c].end()); }
+
+				sorted_z_ = true;
+			}
+		}
+
+		[[nodiscard]] inline auto slots() -> PointSlots<Point_type> * { return slots_ ? &*slots_ : nullptr; }
+
+		// With DYNAMIC, records the slot of every point in its cell
+		inline void index_slots(const chs::flags::build::flags_t flags)
+		{
+			if (not(flags & chs::flags::build::DYNAMIC)) { return; }
+
+			slots_.emplace();
+			slots_->reserve(ranges::accumulate(cells_, std::size_t{ 0 },
+			                                   [](const auto acc, const auto & cell) { return acc + cell.size(); }));
+			for (const auto & cell : cells_)
+			{
+				for (std::size_t s = 0; s < cell.size(); s++) { slots_->set(cell[s], s); }
+			}
+		}
+
+		inline void place(Point_type & point)
+		{
+			chs::cell_insert(at(coord2indices(point)), &point, sorted_z_, slots());
+		}
+
+		// Grows the grid to hold box, placing its points again in the cells they fall in now
+		inline void extend(const Box & box)
+		{
+			if (not chs::extend_grid<Dim>(box_, sizes_, resolutions_, box)) { return; }
+
+			auto old = std::exchange(cells_, std::vector<cell_type, cells_allocator>(cells_.get_allocator()));
+			cells_.resize(std::apply([](const auto... sizes) { return (sizes * ...); }, sizes_));
+			for (auto & cell : old)
+			{
+				for (auto * point : cell) { place(*point); }
+			}
+		}
+
+		// Fills the heap with the nearest points to p but skip, widening the search until no closer ones can be left
+		inline void knn_expand(const Point_type & p, chs::knn_heap<Point_type *> & heap,
+		                       const Point_type * skip = nullptr) const
+		{
+			const auto insert = [&](Point_type * point) {
+				if (point != skip) { heap.push(chs::sq_distance(p, *point), point); }
+			};
+
+			// Search radius starts within the cell containing p
+			double search_radius = idx2box(coord2indices(p)).distance_to_wall(p, /* inside = */ true);
+
+			// Taboo list (to avoid visiting the same cell twice)
+			indices_type taboo_mins;
+			indices_type taboo_maxs;
+
+			auto is_taboo = [&](const auto & indices) {
+				return chs::within_closed_bounds<Dim>(indices, taboo_mins, taboo_maxs);
+			};
+
+			// Do an increasing search
+			const double default_radius_increment = chs::min<Dim>(resolutions_);
+
+			// Explore first the neighbors of the cell containing p
+			{
+				const auto indices = coord2indices(p);
+				taboo_mins         = indices;
+				taboo_maxs         = indices;
+				for (auto * point : at(indices)) { insert(point); }
+			}
+
+			while (
+			        // not enough candidates or last candidate is outside the search radius
+			        (not heap.full() or heap.worst() > (search_radius * search_radius)) and
+			        // we have not visited all the cells
+			        not chs::all_visited<Dim>(taboo_mins, taboo_maxs, sizes_))
+			{
+				// Estimate the new required search radius -> k * density -> Saves time ~86% of the queries
+				if (not heap.empty() and search_radius > 0)
+				{
+					const auto density_based_radius = chs::radius_for_density(
+					        heap.count_within(search_radius * search_radius), search_radius, heap.capacity());
+					search_radius = std::min(density_based_radius,
+					                         search_radius + default_radius_increment);
+				}
+				else { search_radius += default_radius_increment; }
+
+				const auto min = coord2indices(p - search_radius);
+				const auto max = coord2indices(p + search_radius);
+
+				// If min == taboo_mins and max == taboo_maxs, we have already visited all the cells
+				if (chs::all_equal<Dim>(min, taboo_mins) and chs::all_equal<Dim>(max, taboo_maxs))
+				{
+					continue;
+				}
+
+				for (const auto indices : chs::cartesian<Dim>(min, max))
+				{
+					if (is_taboo(indices)) { continue; }
+					for (auto * point : at(indices)) { insert(point); }
+				}
+
+				taboo_mins = min;
+				taboo_maxs = max;
+			}
+		}
+
+		// Same, among the points of the cells within radius of p, which must hold enough of them
+		inline void knn_within(const Point_type & p, const double radius, chs::knn_heap<Point_type *> & heap,
+		                       const Point_type * skip = nullptr) const
+		{
+			const auto insert = [&](Point_type * point) {
+				if (point != skip) { heap.push(chs::sq_distance(p, *point), point); }
+			};
+
+			for (const auto indices : chs::cartesian<Dim>(coord2indices(p - radius), coord2indices(p + radius)))
+			{
+				for (auto * point : at(indices)) { insert(point); }
+			}
+		}
+
 		public:
 		Dense() = delete;
 
 		template<ranges::range Points_rng>
-		Dense(Points_rng & points, const resolution_type res, chs::flags::build::flags_t flags = {}) :
-		        Dense(points, dimensions_type{ n_tuple<Dim>(res) }, flags)
+		Dense(Points_rng & points, const resolution_type res, chs::flags::build::flags_t flags = {},
+		      const Allocator_type & alloc = {}) :
+		        Dense(points, dimensions_type{ n_tuple<Dim>(res) }, flags, alloc)
 		{}
 
 		template<ranges::range Points_rng> // requires to be sortable
-		Dense(Points_rng & points, dimensions_type res, chs::flags::build::flags_t flags = {}) :
-		        resolutions_(res), box_(Box::mbb(points))
+		Dense(Points_rng & points, dimensions_type res, chs::flags::build::flags_t flags = {},
+		      const Allocator_type & alloc = {}) :
+		        resolutions_(res), box_(Box::mbb(points)), cells_(cells_allocator(alloc))
 		{
 			// Number of cells in each dimension
 			[&]<std::size_t... Is>(std::index_sequence<Is...>) {
@@ -145,12 +313,67 @@ namespace chs
 			}
 
 			// Assign points to cells
+			if constexpr (ranges::random_access_range<Points_rng>)
+			{
+				if (flags & chs::flags::build::PARALLEL)
+				{
+					// Group the points by cell with a counting sort, then fill each cell in one go
+					auto       first   = ranges::begin(points);
+					const auto buckets = chs::bucket<std::size_t>(
+					        static_cast<std::size_t>(ranges::distance(points)), num_cells,
+					        [&](const std::size_t i) { return indices2global(coord2indices(first[i])); }, true);
+
+					#pragma omp parallel for schedule(dynamic, 1024)
+					for (std::size_t c = 0; c < num_cells; c++)
+					{
+						auto & cell = cells_[c];
+						cell.reserve(buckets.offsets[c + 1] - buckets.offsets[c]);
+						for (auto i = buckets.offsets[c]; i < buckets.offsets[c + 1]; i++)
+						{
+							cell.emplace_back(&first[buckets.order[i]]);
+						}
+					}
+					sort_cells_z(flags);
+					index_slots(flags);
+					return;
+				}
+			}
+
 			ranges::for_each(points, [&](auto & point) { at(coord2indices(point)).emplace_back(&point); });
 
 			if (flags & chs::flags::build::SHRINK_TO_FIT)
 			{
 				ranges::for_each(cells_, [](auto & cell) { cell.shrink_to_fit(); });
 			}
+			sort_cells_z(flags);
+			index_slots(flags);
+		}
+
+		/**
+		 * @brief Adds the points to the map, first growing it if some fall outside its box. As the points the map was
+		 * built on, they must stay where they are while in it.
+		 */
+		template<ranges::range Points_rng>
+		inline void insert(Points_rng & points)
+		{
+			extend(Box::mbb(points));
+			for (auto & point : points) { place(point); }
+		}
+
+		inline void insert(Point_type & point)
+		{
+			extend(Box(std::make_pair(Point(point), Point(point))));
+			place(point);
+		}
+
+		/**
+		 * @brief Takes the point out of the map, filling its slot with the last point of its cell. The point must have
+		 * the coordinates it was added with.
+		 * @return Whether the point was in the map
+		 */
+		inline auto remove(const Point_type & point) -> bool
+		{
+			return chs::cell_remove(at(coord2indices(point)), &point, sorted_z_, slots());
 		}
 
 		template<chs::concepts::Kernel<chs::Point> Kernel_t>
@@ -163,106 +386,234 @@ namespace chs
 		template<chs::concepts::Kernel<chs::Point> Kernel_t, chs::concepts::Filter<Point_type> Filter_t>
 		[[nodiscard]] inline auto query(const Kernel_t & kernel, Filter_t && filter) const
 		{
-			std::vector<Point *> points;
+			std::vector<Point_type *> points;
 
 			const auto min = coord2indices(kernel.box().min());
 			const auto max = coord2indices(kernel.box().max());
 
 			for (const auto indices : chs::cartesian<Dim>(min, max))
 			{
-				const auto & cell = at(indices);
-				for (const auto & point : cell)
+				if constexpr (chs::concepts::ClassifyingKernel<Kernel_t, chs::Point>)
 				{
-					if (kernel.is_inside(*point) and filter(*point)) { points.emplace_back(point); }
+					collect(indices, kernel.classify(idx2box(indices)), kernel, filter, points);
 				}
+				else { collect(indices, Position::PARTIAL, kernel, filter, points); }
 			}
 
+			if constexpr (chs::concepts::SelectingKernel<Kernel_t, Point_type>) { kernel.select(points); }
+
 			return points;
 		}
 
-		[[nodiscard]] inline auto knn(const std::integral auto k, const Point_type & p) const
+		/**
+		 * @brief Runs every kernel of the range and calls callback(i, neighbours) with the points inside kernels[i],
+		 * as a range of Point_type *, valid only during the call. Returns the work done.
+		 *
+		 * Kernels are grouped by the cell their box starts in. The points of the cells spanned by a group are gathered
+		 * once and tested against each kernel of the group, in per-thread buffers reused between groups. With SORT_Z
+		 * each kernel instead tests, in every cell of its group, only the points within the height of its box.
+		 * Kernels that classify cells skip those outside them and take those inside them whole.
+		 */
+		template<ranges::random_access_range Kernels_rng, typename Callback_t>
+		inline auto query_batch(const Kernels_rng & kernels, Callback_t && callback) const -> QueryStats
 		{
-			// Store the points and the distance
-			chs::sorted_vector<std::pair<double, Point_type *>> candidates(k);
-
-			// Search radius starts within the cell containing p
-			double search_radius = idx2box(coord2indices(p)).distance_to_wall(p, /* inside = */ true);
+			return run_batch<false>(kernels, callback);
+		}
 
-			auto candidates_within_sq_radius = [&] {
-				const auto sq_radius = search_radius * search_radius;
-				const auto it        = std::upper_bound(candidates.begin(), candidates.end(), sq_radius,
-				                                        [](auto d, auto & pt) { return d < pt.first; });
-				return it - candidates.begin();
-			};
+		/**
+		 * @brief Same traversal as query_batch(), calling callback(i, count) with the number of points inside
+		 * kernels[i] instead of the points themselves
+		 */
+		template<ranges::random_access_range Kernels_rng, typename Callback_t>
+		inline auto count_batch(const Kernels_rng & kernels, Callback_t && callback) const -> QueryStats
+		{
+			return run_batch<true>(kernels, callback);
+		}
 
-			// Taboo list (to avoid visiting the same cell twice)
-			indices_type taboo_mins;
-			indices_type taboo_maxs;
+		private:
+		template<bool Count, ranges::random_access_range Kernels_rng, typename Callback_t>
+		inline auto run_batch(const Kernels_rng & kernels, Callback_t && callback) const -> QueryStats
+		{
+			const auto first = ranges::begin(kernels);
+			using kernel_type  = ranges::range_value_t<Kernels_rng>;
+			constexpr bool classify = chs::concepts::ClassifyingKernel<kernel_type, chs::Point>;
+			const bool     prune    = sorted_z_ and chs::bounds_z<kernel_type>;
+			// Pruned or classified kernels walk the cells of their group one by one instead of a shared list
+			const bool     by_cell  = prune or classify;
+			const auto groups = chs::group<std::size_t>(
+			        static_cast<std::size_t>(ranges::distance(kernels)),
+			        [&](const std::size_t i) { return indices2global(coord2indices(first[i].box().min())); }, true);
+
+			QueryStats stats;
+
+			#pragma omp parallel
+			{
+				std::vector<Point_type *>                                candidates;
+				std::vector<Point_type *>                                neighbours;
+				std::vector<std::pair<indices_type, const cell_type *>> cells;
+				QueryStats                                               local;
 
-			auto is_taboo = [&](const auto & indices) {
-				return chs::within_closed_bounds<Dim>(indices, taboo_mins, taboo_maxs);
-			};
+				#pragma omp for schedule(dynamic, 16)
+				for (std::size_t g = 0; g < groups.keys.size(); g++)
+				{
+					// Cells spanned by any kernel of the group
+					auto min = coord2indices(first[groups.order[groups.offsets[g]]].box().min());
+					auto max = min;
+					for (auto q = groups.offsets[g]; q < groups.offsets[g + 1]; q++)
+					{
+						const auto box = first[groups.order[q]].box();
+						chs::min_into<Dim>(min, coord2indices(box.min()));
+						chs::max_into<Dim>(max, coord2indices(box.max()));
+					}
 
-			// Do an increasing search
-			const double default_radius_increment = chs::min<Dim>(resolutions_);
+					candidates.clear();
+					cells.clear();
+					for (const auto indices : chs::cartesian<Dim>(min, max))
+					{
+						local.cells++;
+						const auto & cell = at(indices);
+						if (by_cell) { cells.emplace_back(indices, &cell); }
+						else { candidates.insert(candidates.end(), cell.begin(), cell.end()); }
+					}
 
-			// Explore first the neighbors of the cell containing p
-			{
-				const auto indices = coord2indices(p);
-				taboo_mins         = indices;
-				taboo_maxs         = indices;
-				const auto & cell  = at(indices);
-				for (const auto & point : cell)
-				{
-					candidates.insert({ chs::sq_distance(p, *point), point });
+					for (auto q = groups.offsets[g]; q < groups.offsets[g + 1]; q++)
+					{
+						const auto kernel = first[groups.order[q]];
+						// Selecting kernels pick from the points, which must then be kept even to count them
+						constexpr bool keep =
+						        not Count or chs::concepts::SelectingKernel<decltype(kernel), Point_type>;
+
+						neighbours.clear();
+						std::size_t inside = 0;
+						const auto  test   = [&](const auto & points, const Position position) {
+							// The points of an INSIDE cell are all neighbours, without testing them
+							if (position == Position::INSIDE)
+							{
+								if constexpr (keep)
+								{
+									neighbours.insert(neighbours.end(), points.begin(), points.end());
+								}
+								else { inside += static_cast<std::size_t>(ranges::distance(points)); }
+								return;
+							}
+							for (auto * point : points)
+							{
+								if (kernel.is_inside(*point))
+								{
+									if constexpr (keep) { neighbours.emplace_back(point); }
+									else { inside++; }
+								}
+							}
+							local.candidates += static_cast<std::size_t>(ranges::distance(points));
+						};
+						if (by_cell)
+						{
+							for (const auto & [indices, cell] : cells)
+							{
+								auto position = Position::PARTIAL;
+								if constexpr (classify)
+								{
+									position = kernel.classify(idx2box(indices));
+									if (position == Position::OUTSIDE) { continue; }
+								}
+								if (prune)
+								{
+									const auto [lo, hi] = chs::z_range(cell->begin(), cell->end(),
+									                                   kernel.box().min()[2], kernel.box().max()[2]);
+									test(ranges::subrange(lo, hi), position);
+								}
+								else { test(*cell, position); }
+							}
+						}
+						else { test(candidates, Position::PARTIAL); }
+						if constexpr (chs::concepts::SelectingKernel<decltype(kernel), Point_type>)
+						{
+							kernel.select(neighbours);
+						}
+						if constexpr (keep) { inside = neighbours.size(); }
+						if constexpr (Count) { callback(groups.order[q], inside); }
+						else { callback(groups.order[q], std::as_const(neighbours)); }
+
+						local.queries++;
+						local.found += inside;
+					}
 				}
+
+				#pragma omp critical
+				stats += local;
 			}
 
-			while (
-			        // not enough candidates or last candidate is outside the search radius
-			        (std::cmp_less(candidates.size(), k) or
-			         candidates.back().first > (search_radius * search_radius)) and
-			        // we have not visited all the cells
-			        not chs::all_visited<Dim>(taboo_mins, taboo_maxs, sizes_))
-			{
-				// Estimate the new required search radius -> k * density -> Saves time ~86% of the queries
-				if (not candidates.empty() and search_radius > 0)
-				{
-					const auto density_based_radius = chs::radius_for_density(
-					        candidates_within_sq_radius(), search_radius, k);
-					search_radius = std::min(density_based_radius,
-					                         search_radius + default_radius_increment);
-				}
-				else { search_radius += default_radius_increment; }
+			return stats;
+		}
 
-				const auto min = coord2indices(p - search_radius);
-				const auto max = coord2indices(p + search_radius);
+		public:
 
-				// If min == taboo_mins and max == taboo_maxs, we have already visited all the cells
-				if (chs::all_equal<Dim>(min, taboo_mins) and chs::all_equal<Dim>(max, taboo_maxs))
-				{
-					continue;
-				}
+		[[nodiscard]] inline auto knn(const std::integral auto k, const Point_type & p) const
+		{
+			// Points and their distance, from the closest
+			std::vector<std::pair<double, Point_type *>> neighbours;
+			if (k <= 0) { return neighbours; }
+
+			chs::knn_heap<Point_type *> heap(static_cast<std::size_t>(k));
+			knn_expand(p, heap);
+
+			neighbours.reserve(heap.size());
+			heap.drain([&](const double sq_distance, Point_type * point) {
+				neighbours.emplace_back(std::sqrt(sq_distance), point);
+			});
+			return neighbours;
+		}
 
-				for (const auto indices : chs::cartesian<Dim>(min, max))
+		/**
+		 * @brief k nearest neighbours of every point of the range, not counting the point itself. The range must hold
+		 * the points the map was built on, contiguous, and neighbours are given as indices into it.
+		 *
+		 * Points are processed in parallel cell by cell. The first point of a cell widens its search as knn() does,
+		 * the rest only look within the radius of the previous one plus the distance between both, which holds at
+		 * least k other points.
+		 */
+		template<ranges::contiguous_range Points_rng>
+		[[nodiscard]] inline auto knn_graph(const Points_rng & points, const std::size_t k) const -> KnnGraph
+		{
+			const auto * base = ranges::data(points);
+			const auto   n    = static_cast<std::size_t>(ranges::size(points));
+			const auto   row  = n > 0 ? std::min(k, n - 1) : std::size_t{ 0 };
+
+			KnnGraph graph;
+			graph.offsets.resize(n + 1);
+			for (std::size_t i = 0; i <= n; i++) { graph.offsets[i] = i * row; }
+			graph.neighbours.resize(n * row);
+			graph.distances.resize(n * row);
+			if (row == 0) { return graph; }
+
+			#pragma omp parallel
+			{
+				chs::knn_heap<Point_type *> heap(row);
+
+				const auto add = [&](Point_type * point, const Point_type *& prev, double & prev_radius) {
+					if (prev == nullptr) { knn_expand(*point, heap, point); }
+					else { knn_within(*point, prev_radius + chs::distance(*prev, *point), heap, point); }
+					prev        = point;
+					prev_radius = std::sqrt(heap.worst());
+
+					auto entry = graph.offsets[static_cast<std::size_t>(point - base)];
+					heap.drain([&](const double sq_distance, Point_type * neighbour) {
+						graph.neighbours[entry] = static_cast<std::size_t>(neighbour - base);
+						graph.distances[entry]  = std::sqrt(sq_distance);
+						entry++;
+					});
+				};
+
+				#pragma omp for schedule(dynamic, 64)
+				for (std::size_t c = 0; c < cells_.size(); c++)
 				{
-					if (is_taboo(indices)) { continue; }
-
-					const auto & cell = at(indices);
-					for (const auto & point : cell)
-					{
-						candidates.insert({ chs::sq_distance(p, *point), point });
-					}
+					const Point_type * prev = nullptr;
+					double             prev_radius{};
+					for (auto * point : cells_[c]) { add(point, prev, prev_radius); }
 				}
-
-				taboo_mins = min;
-				taboo_maxs = max;
 			}
 
-			ranges::for_each(candidates,
-			                 [](auto & candidate) { candidate.first = std::sqrt(candidate.first); });
-
-			return candidates;
+			return graph;
 		}
 
 		[[nodiscard]] inline auto mem_footprint() const
@@ -274,6 +625,7 @@ namespace chs
 				bytes += sizeof(cell);
 				bytes += cell.capacity() * sizeof(Point_type *);
 			}
+			if (slots_) { bytes += slots_->mem_footprint(); }
 
 			return bytes;
 		}
@@ -0,0 +1,763 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <range/v3/all.hpp>
+
+#include "cheesemap/concepts/concepts.hpp"
+#include "cheesemap/kernels/kernels.hpp"
+
+#include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/Position.hpp"
+#include "cheesemap/utils/knn.hpp"
+#include "cheesemap/utils/mapped_file.hpp"
+#include "cheesemap/utils/stats.hpp"
+
+#include "cheesemap/utils/arithmetic.hpp"
+#include "cheesemap/utils/bucketing.hpp"
+#include "cheesemap/utils/Cartesian.hpp"
+#include "cheesemap/utils/flags.hpp"
+#include "cheesemap/utils/type_traits.hpp"
+#include "cheesemap/utils/zsort.hpp"
+
+namespace chs
+{
+	/**
+	 * @brief Dense grid in compressed sparse row layout: the points of cell c are entries offsets[c] ... offsets[c + 1]
+	 * - 1 of a single array, filled by a counting sort. With REORDER the points themselves are sorted by cell and the
+	 * array of pointers is dropped, so cells index straight into the points. A map saved with save() and loaded with
+	 * load() reads both arrays from the memory mapped file instead, as indices into the points.
+	 */
+	template<typename Point_type, std::size_t Dim = 3, typename Index_type = std::uint32_t>
+	class DenseCSR
+	{
+		protected:
+		using resolution_type = double;
+		using dimensions_type = chs::type_traits::tuple<resolution_type, Dim>;
+		using indices_type    = chs::type_traits::tuple<std::size_t, Dim>;
+
+		static constexpr dimensions_type DEFAULT_RESOLUTIONS = chs::n_tuple<Dim>(resolution_type{ 1 });
+
+		// Dimension of each cell
+		dimensions_type resolutions_ = DEFAULT_RESOLUTIONS;
+
+		// Bounding box of the map
+		Box box_;
+
+		// Number of cells of the map on each dimension
+		indices_type sizes_;
+
+		// First entry of each cell, plus the total number of points
+		std::vector<Index_type> offsets_;
+
+		// Points sorted by cell, empty if the points themselves were reordered
+		std::vector<Point_type *> points_;
+
+		// First of the reordered points
+		Point_type * base_{};
+
+		// Points of each cell sorted by z (SORT_Z)
+		bool sorted_z_{};
+
+		// File the map was loaded from, holding its offsets and the indices of its points from base_
+		std::shared_ptr<const MappedFile> file_;
+		std::span<const Index_type>       file_offsets_;
+		std::span<const Index_type>       file_indices_;
+
+		// Layout of the files written by save(): this header, the offsets and the indices of the points
+		struct FileHeader
+		{
+			char          magic[8];
+			std::uint32_t version;
+			std::uint32_t dim;
+			std::uint32_t index_size;
+			std::uint32_t sorted_z;
+			std::uint64_t fingerprint;
+			std::uint64_t num_points;
+			std::uint64_t num_cells;
+			std::uint64_t sizes[Dim];
+			double        resolutions[Dim];
+			double        box_min[3];
+			double        box_max[3];
+		};
+
+		static constexpr char          FILE_MAGIC[8] = "CHS-CSR";
+		static constexpr std::uint32_t FILE_VERSION  = 1;
+
+		explicit DenseCSR(const FileHeader & header) :
+		        box_(std::make_pair(Point{ header.box_min[0], header.box_min[1], header.box_min[2] },
+		                            Point{ header.box_max[0], header.box_max[1], header.box_max[2] })),
+		        sorted_z_(header.sorted_z != 0)
+		{
+			[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+				((std::get<Is>(resolutions_) = header.resolutions[Is],
+				  std::get<Is>(sizes_)       = static_cast<std::size_t>(header.sizes[Is])),
+				 ...);
+			}(std::make_index_sequence<Dim>{});
+		}
+
+		// First entry of each cell, plus the total number of points
+		[[nodiscard]] inline auto offsets() const -> std::span<const Index_type>
+		{
+			return file_ ? file_offsets_ : std::span<const Index_type>(offsets_);
+		}
+
+		template<std::size_t... Is>
+		[[nodiscard]] inline auto indices2global(const auto & indices, std::index_sequence<Is...>) const
+		{
+			std::size_t idx = 0;
+
+			((idx = idx * std::get<Is>(sizes_) + std::get<Is>(indices)), ...);
+
+			return idx;
+		}
+
+		[[nodiscard]] inline auto indices2global(const auto & indices) const
+		{
+			return indices2global(indices, std::make_index_sequence<Dim>{});
+		}
+
+		template<std::size_t... Is>
+		[[nodiscard]] inline auto idx2box(const auto & idx, std::index_sequence<Is...>) const
+		{
+			Point min = box_.min();
+			Point max = box_.max();
+
+			(((min[Is] = box_.min()[Is] +
+			             static_cast<resolution_type>(std::get<Is>(idx)) * std::get<Is>(resolutions_)),
+			  (max[Is] = min[Is] + std::get<Is>(resolutions_))),
+			 ...);
+
+			return Box(std::make_pair(min, max));
+		}
+
+		[[nodiscard]] inline auto idx2box(const auto & idx) const
+		{
+			return idx2box(idx, std::make_index_sequence<Dim>{});
+		}
+
+		template<std::size_t... Is>
+		[[nodiscard]] inline auto coord2indices(const Point & p, std::index_sequence<Is...>) const
+		{
+			indices_type idx;
+
+			resolution_type diff;
+
+			(((diff = p[Is] - box_.min()[Is]),
+			  (diff = std::clamp(diff, 0.0, box_.max()[Is] - box_.min()[Is])),
+			  (std::get<Is>(idx) = static_cast<std::size_t>(diff / std::get<Is>(resolutions_)))),
+			 ...);
+
+			return idx;
+		}
+
+		[[nodiscard]] inline auto coord2indices(const Point & p) const
+		{
+			return coord2indices(p, std::make_index_sequence<Dim>{});
+		}
+
+		// Calls fn with a pointer to each point of the cell with global index c
+		inline void for_each_in_cell(const std::size_t c, auto && fn) const
+		{
+			const auto offsets = this->offsets();
+			if (file_)
+			{
+				for (auto i = offsets[c]; i < offsets[c + 1]; i++) { fn(base_ + file_indices_[i]); }
+			}
+			else if (points_.empty())
+			{
+				for (auto i = offsets[c]; i < offsets[c + 1]; i++) { fn(base_ + i); }
+			}
+			else
+			{
+				for (auto i = offsets[c]; i < offsets[c + 1]; i++) { fn(points_[i]); }
+			}
+		}
+
+		// Same, skipping the points outside [z_min, z_max] if the cells are sorted by z
+		inline void for_each_in_cell(const std::size_t c, auto && fn, const double z_min, const double z_max) const
+		{
+			if (not sorted_z_) { return for_each_in_cell(c, fn); }
+
+			if (file_)
+			{
+				const auto first = file_indices_.begin() + file_offsets_[c];
+				const auto last  = file_indices_.begin() + file_offsets_[c + 1];
+				const auto lo    = std::lower_bound(first, last, z_min,
+				                                    [&](const Index_type i, const double z) { return base_[i][2] < z; });
+				const auto hi    = std::upper_bound(lo, last, z_max,
+				                                    [&](const double z, const Index_type i) { return z < base_[i][2]; });
+				for (auto it = lo; it != hi; it++) { fn(base_ + *it); }
+			}
+			else if (points_.empty())
+			{
+				const auto [lo, hi] = chs::z_range(base_ + offsets_[c], base_ + offsets_[c + 1], z_min, z_max);
+				for (auto * point = lo; point != hi; point++) { fn(point); }
+			}
+			else
+			{
+				const auto [lo, hi] =
+				        chs::z_range(points_.begin() + offsets_[c], points_.begin() + offsets_[c + 1], z_min, z_max);
+				for (auto it = lo; it != hi; it++) { fn(*it); }
+			}
+		}
+
+		inline void for_each_in(const auto & indices, auto && fn) const
+		{
+			for_each_in_cell(indices2global(indices), fn);
+		}
+
+		// With SORT_Z, sorts the points of every cell by height. Only for 2D maps, whose cells span the whole height
+		inline void sort_cells_z(const chs::flags::build::flags_t flags)
+		{
+			if constexpr (Dim == 2)
+			{
+				if (not(flags & chs::flags::build::SORT_Z)) { return; }
+
+				const auto num_cells = offsets_.size() - 1;
+
+				#pragma omp parallel for schedule(dynamic, 256) if (flags & chs::flags::build::PARALLEL)
+				for (std::size_t c = 0; c < num_cells; c++)
+				{
+					if (points_.empty()) { chs::sort_z(base_ + offsets_[c], base_ + offsets_[c + 1]); }
+					else { chs::sort_z(points_.begin() + offsets_[c], points_.begin() + offsets_[c + 1]); }
+				}
+
+				sorted_z_ = true;
+			}
+		}
+
+		// Adds the points of the cell inside the kernel that pass the filter, only testing them if it is PARTIAL
+		inline void collect(const auto & indices, const Position position, const auto & kernel, auto && filter,
+		                    std::vector<Point_type *> & points) const
+		{
+			if (position == Position::OUTSIDE) { return; }
+			const auto add = [&](Point_type * point) {
+				if ((position == Position::INSIDE or kernel.is_inside(*point)) and filter(*point))
+				{
+					points.emplace_back(point);
+				}
+			};
+			if constexpr (chs::bounds_z<decltype(kernel)>)
+			{
+				for_each_in_cell(indices2global(indices), add, kernel.box().min()[2], kernel.box().max()[2]);
+			}
+			else { for_each_in_cell(indices2global(indices), add); }
+		}
+
+		// Fills the heap with the nearest points to p but skip, widening the search until no closer ones can be left
+		inline void knn_expand(const Point_type & p, chs::knn_heap<Point_type *> & heap,
+		                       const Point_type * skip = nullptr) const
+		{
+			const auto insert = [&](Point_type * point) {
+				if (point != skip) { heap.push(chs::sq_distance(p, *point), point); }
+			};
+
+			// Search radius starts within the cell containing p
+			double search_radius = idx2box(coord2indices(p)).distance_to_wall(p, /* inside = */ true);
+
+			// Taboo list (to avoid visiting the same cell twice)
+			indices_type taboo_mins;
+			indices_type taboo_maxs;
+
+			auto is_taboo = [&](const auto & indices) {
+				return chs::within_closed_bounds<Dim>(indices, taboo_mins, taboo_maxs);
+			};
+
+			// Do an increasing search
+			const double default_radius_increment = chs::min<Dim>(resolutions_);
+
+			// Explore first the neighbors of the cell containing p
+			{
+				const auto indices = coord2indices(p);
+				taboo_mins         = indices;
+				taboo_maxs         = indices;
+				for_each_in(indices, insert);
+			}
+
+			while (
+			        // not enough candidates or last candidate is outside the search radius
+			        (not heap.full() or heap.worst() > (search_radius * search_radius)) and
+			        // we have not visited all the cells
+			        not chs::all_visited<Dim>(taboo_mins, taboo_maxs, sizes_))
+			{
+				// Estimate the new required search radius -> k * density -> Saves time ~86% of the queries
+				if (not heap.empty() and search_radius > 0)
+				{
+					const auto density_based_radius = chs::radius_for_density(
+					        heap.count_within(search_radius * search_radius), search_radius, heap.capacity());
+					search_radius = std::min(density_based_radius,
+					                         search_radius + default_radius_increment);
+				}
+				else { search_radius += default_radius_increment; }
+
+				const auto min = coord2indices(p - search_radius);
+				const auto max = coord2indices(p + search_radius);
+
+				// If min == taboo_mins and max == taboo_maxs, we have already visited all the cells
+				if (chs::all_equal<Dim>(min, taboo_mins) and chs::all_equal<Dim>(max, taboo_maxs))
+				{
+					continue;
+				}
+
+				for (const auto indices : chs::cartesian<Dim>(min, max))
+				{
+					if (is_taboo(indices)) { continue; }
+					for_each_in(indices, insert);
+				}
+
+				taboo_mins = min;
+				taboo_maxs = max;
+			}
+		}
+
+		// Same, among the points of the cells within radius of p, which must hold enough of them
+		inline void knn_within(const Point_type & p, const double radius, chs::knn_heap<Point_type *> & heap,
+		                       const Point_type * skip = nullptr) const
+		{
+			const auto insert = [&](Point_type * point) {
+				if (point != skip) { heap.push(chs::sq_distance(p, *point), point); }
+			};
+
+			for (const auto indices : chs::cartesian<Dim>(coord2indices(p - radius), coord2indices(p + radius)))
+			{
+				for_each_in(indices, insert);
+			}
+		}
+
+		public:
+		DenseCSR() = delete;
+
+		template<ranges::random_access_range Points_rng>
+		DenseCSR(Points_rng & points, const resolution_type res, chs::flags::build::flags_t flags = {}) :
+		        DenseCSR(points, dimensions_type{ n_tuple<Dim>(res) }, flags)
+		{}
+
+		template<ranges::random_access_range Points_rng>
+		DenseCSR(Points_rng & points, dimensions_type res, chs::flags::build::flags_t flags = {}) :
+		        resolutions_(res), box_(Box::mbb(points))
+		{
+			const auto n = static_cast<std::size_t>(ranges::distance(points));
+			if (n > std::numeric_limits<Index_type>::max())
+			{
+				throw std::length_error("chs::DenseCSR: too many points for the index type");
+			}
+
+			// Number of cells in each dimension
+			[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+				((std::get<Is>(sizes_) =
+				          static_cast<std::size_t>(std::floor((box_.max()[Is] - box_.min()[Is]) /
+				                                              std::get<Is>(resolutions_))) +
+				          1),
+				 ...);
+			}(std::make_index_sequence<Dim>{});
+
+			const auto num_cells = [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+				std::size_t acc = 1;
+				((acc *= std::get<Is>(sizes_)), ...);
+				return acc;
+			}(std::make_index_sequence<Dim>{});
+
+			auto first = ranges::begin(points);
+
+			// Counting sort of the points by global cell index
+			auto buckets = chs::bucket<Index_type>(
+			        n, num_cells, [&](const std::size_t i) { return indices2global(coord2indices(first[i])); },
+			        flags & chs::flags::build::PARALLEL);
+
+			offsets_ = std::move(buckets.offsets);
+
+			if constexpr (ranges::contiguous_range<Points_rng>)
+			{
+				if (flags & chs::flags::build::REORDER)
+				{
+					std::vector<Point_type> sorted(n);
+
+					#pragma omp parallel for if (flags & chs::flags::build::PARALLEL)
+					for (std::size_t i = 0; i < n; i++) { sorted[i] = std::move(first[buckets.order[i]]); }
+
+					#pragma omp parallel for if (flags & chs::flags::build::PARALLEL)
+					for (std::size_t i = 0; i < n; i++) { first[i] = std::move(sorted[i]); }
+
+					base_ = ranges::data(points);
+					sort_cells_z(flags);
+					return;
+				}
+			}
+
+			points_.resize(n);
+
+			#pragma omp parallel for if (flags & chs::flags::build::PARALLEL)
+			for (std::size_t i = 0; i < n; i++) { points_[i] = &first[buckets.order[i]]; }
+
+			sort_cells_z(flags);
+		}
+
+		template<chs::concepts::Kernel<chs::Point> Kernel_t>
+		[[nodiscard]] inline auto query(const Kernel_t & kernel) const
+		{
+			const auto dummy = []([[maybe_unused]] const auto &) { return true; };
+			return query(kernel, dummy);
+		}
+
+		template<chs::concepts::Kernel<chs::Point> Kernel_t, chs::concepts::Filter<Point_type> Filter_t>
+		[[nodiscard]] inline auto query(const Kernel_t & kernel, Filter_t && filter) const
+		{
+			std::vector<Point_type *> points;
+
+			const auto min = coord2indices(kernel.box().min());
+			const auto max = coord2indices(kernel.box().max());
+
+			for (const auto indices : chs::cartesian<Dim>(min, max))
+			{
+				if constexpr (chs::concepts::ClassifyingKernel<Kernel_t, chs::Point>)
+				{
+					collect(indices, kernel.classify(idx2box(indices)), kernel, filter, points);
+				}
+				else { collect(indices, Position::PARTIAL, kernel, filter, points); }
+			}
+
+			if constexpr (chs::concepts::SelectingKernel<Kernel_t, Point_type>) { kernel.select(points); }
+
+			return points;
+		}
+
+		/**
+		 * @brief Runs every kernel of the range and calls callback(i, neighbours) with the points inside kernels[i],
+		 * as a range of Point_type *, valid only during the call.
+		 *
+		 * Kernels are grouped by the cell their box starts in. The points of the cells spanned by a group are gathered
+		 * once and tested against each kernel of the group, in per-thread buffers reused between groups. With SORT_Z
+		 * each kernel instead tests, in every cell of its group, only the points within the height of its box.
+		 * Kernels that classify cells skip those outside them and take those inside them whole. Returns
+		 * the work done.
+		 */
+		template<ranges::random_access_range Kernels_rng, typename Callback_t>
+		inline auto query_batch(const Kernels_rng & kernels, Callback_t && callback) const -> QueryStats
+		{
+			return run_batch<false>(kernels, callback);
+		}
+
+		/**
+		 * @brief Same traversal as query_batch(), calling callback(i, count) with the number of points inside
+		 * kernels[i] instead of the points themselves
+		 */
+		template<ranges::random_access_range Kernels_rng, typename Callback_t>
+		inline auto count_batch(const Kernels_rng & kernels, Callback_t && callback) const -> QueryStats
+		{
+			return run_batch<true>(kernels, callback);
+		}
+
+		private:
+		template<bool Count, ranges::random_access_range Kernels_rng, typename Callback_t>
+		inline auto run_batch(const Kernels_rng & kernels, Callback_t && callback) const -> QueryStats
+		{
+			const auto first = ranges::begin(kernels);
+			using kernel_type  = ranges::range_value_t<Kernels_rng>;
+			constexpr bool classify = chs::concepts::ClassifyingKernel<kernel_type, chs::Point>;
+			const bool     prune    = sorted_z_ and chs::bounds_z<kernel_type>;
+			// Pruned or classified kernels walk the cells of their group one by one instead of a shared list
+			const bool     by_cell  = prune or classify;
+			const auto groups = chs::group<std::size_t>(
+			        static_cast<std::size_t>(ranges::distance(kernels)),
+			        [&](const std::size_t i) { return indices2global(coord2indices(first[i].box().min())); }, true);
+
+			QueryStats stats;
+
+			#pragma omp parallel
+			{
+				std::vector<Point_type *>                        candidates;
+				std::vector<Point_type *>                        neighbours;
+				std::vector<std::pair<indices_type, std::size_t>> cells;
+				QueryStats                                       local;
+
+				#pragma omp for schedule(dynamic, 16)
+				for (std::size_t g = 0; g < groups.keys.size(); g++)
+				{
+					// Cells spanned by any kernel of the group
+					auto min = coord2indices(first[groups.order[groups.offsets[g]]].box().min());
+					auto max = min;
+					for (auto q = groups.offsets[g]; q < groups.offsets[g + 1]; q++)
+					{
+						const auto box = first[groups.order[q]].box();
+						chs::min_into<Dim>(min, coord2indices(box.min()));
+						chs::max_into<Dim>(max, coord2indices(box.max()));
+					}
+
+					candidates.clear();
+					cells.clear();
+					for (const auto indices : chs::cartesian<Dim>(min, max))
+					{
+						local.cells++;
+						if (by_cell) { cells.emplace_back(indices, indices2global(indices)); }
+						else { for_each_in(indices, [&](Point_type * point) { candidates.emplace_back(point); }); }
+					}
+
+					for (auto q = groups.offsets[g]; q < groups.offsets[g + 1]; q++)
+					{
+						const auto kernel = first[groups.order[q]];
+						// Selecting kernels pick from the points, which must then be kept even to count them
+						constexpr bool keep =
+						        not Count or chs::concepts::SelectingKernel<decltype(kernel), Point_type>;
+
+						neighbours.clear();
+						std::size_t inside = 0;
+						const auto  take   = [&](Point_type * point) {
+							if constexpr (keep) { neighbours.emplace_back(point); }
+							else { inside++; }
+						};
+						const auto test = [&](Point_type * point) {
+							if (kernel.is_inside(*point)) { take(point); }
+							local.candidates++;
+						};
+						if (by_cell)
+						{
+							for (const auto & [indices, c] : cells)
+							{
+								// The points of an INSIDE cell are all neighbours, without testing them
+								auto position = Position::PARTIAL;
+								if constexpr (classify)
+								{
+									position = kernel.classify(idx2box(indices));
+									if (position == Position::OUTSIDE) { continue; }
+								}
+								const auto visit = [&](auto && fn) {
+									if (not prune) { return for_each_in_cell(c, fn); }
+									for_each_in_cell(c, fn, kernel.box().min()[2], kernel.box().max()[2]);
+								};
+								if (position == Position::INSIDE) { visit(take); }
+								else { visit(test); }
+							}
+						}
+						else { ranges::for_each(candidates, test); }
+						if constexpr (chs::concepts::SelectingKernel<decltype(kernel), Point_type>)
+						{
+							kernel.select(neighbours);
+						}
+						if constexpr (keep) { inside = neighbours.size(); }
+						if constexpr (Count) { callback(groups.order[q], inside); }
+						else { callback(groups.order[q], std::as_const(neighbours)); }
+
+						local.queries++;
+						local.found += inside;
+					}
+				}
+
+				#pragma omp critical
+				stats += local;
+			}
+
+			return stats;
+		}
+
+		public:
+
+		[[nodiscard]] inline auto knn(const std::integral auto k, const Point_type & p) const
+		{
+			// Points and their distance, from the closest
+			std::vector<std::pair<double, Point_type *>> neighbours;
+			if (k <= 0) { return neighbours; }
+
+			chs::knn_heap<Point_type *> heap(static_cast<std::size_t>(k));
+			knn_expand(p, heap);
+
+			neighbours.reserve(heap.size());
+			heap.drain([&](const double sq_distance, Point_type * point) {
+				neighbours.emplace_back(std::sqrt(sq_distance), point);
+			});
+			return neighbours;
+		}
+
+		/**
+		 * @brief k nearest neighbours of every point of the range, not counting the point itself. The range must hold
+		 * the points the map was built on, contiguous, and neighbours are given as indices into it.
+		 *
+		 * Points are processed in parallel cell by cell. The first point of a cell widens its search as knn() does,
+		 * the rest only look within the radius of the previous one plus the distance between both, which holds at
+		 * least k other points.
+		 */
+		template<ranges::contiguous_range Points_rng>
+		[[nodiscard]] inline auto knn_graph(const Points_rng & points, const std::size_t k) const -> KnnGraph
+		{
+			const auto * base = ranges::data(points);
+			const auto   n    = static_cast<std::size_t>(ranges::size(points));
+			const auto   row  = n > 0 ? std::min(k, n - 1) : std::size_t{ 0 };
+
+			KnnGraph graph;
+			graph.offsets.resize(n + 1);
+			for (std::size_t i = 0; i <= n; i++) { graph.offsets[i] = i * row; }
+			graph.neighbours.resize(n * row);
+			graph.distances.resize(n * row);
+			if (row == 0) { return graph; }
+
+			#pragma omp parallel
+			{
+				chs::knn_heap<Point_type *> heap(row);
+
+				const auto add = [&](Point_type * point, const Point_type *& prev, double & prev_radius) {
+					if (prev == nullptr) { knn_expand(*point, heap, point); }
+					else { knn_within(*point, prev_radius + chs::distance(*prev, *point), heap, point); }
+					prev        = point;
+					prev_radius = std::sqrt(heap.worst());
+
+					auto entry = graph.offsets[static_cast<std::size_t>(point - base)];
+					heap.drain([&](const double sq_distance, Point_type * neighbour) {
+						graph.neighbours[entry] = static_cast<std::size_t>(neighbour - base);
+						graph.distances[entry]  = std::sqrt(sq_distance);
+						entry++;
+					});
+				};
+
+				#pragma omp for schedule(dynamic, 64)
+				for (std::size_t c = 0; c < get_num_cells(); c++)
+				{
+					const Point_type * prev = nullptr;
+					double             prev_radius{};
+					for_each_in_cell(c, [&](Point_type * point) { add(point, prev, prev_radius); });
+				}
+			}
+
+			return graph;
+		}
+
+		[[nodiscard]] inline auto mem_footprint() const
+		{
+			return sizeof(*this) + offsets_.capacity() * sizeof(Index_type) +
+			       points_.capacity() * sizeof(Point_type *);
+		}
+
+		[[nodiscard]] inline auto get_num_cells() const { return offsets().size() - 1; }
+
+		[[nodiscard]] inline auto get_empty_cells() const
+		{
+			const auto  offsets = this->offsets();
+			std::size_t empty   = 0;
+			for (std::size_t c = 0; c + 1 < offsets.size(); c++)
+			{
+				if (offsets[c] == offsets[c + 1]) { empty++; }
+			}
+			return empty;
+		}
+
+		/**
+		 * @brief Writes the map to path, its points as indices into points, the range it was built on or loaded for.
+		 * The fingerprint identifies the input the points come from, and load() only accepts the file for the same
+		 * one. Maps built with REORDER cannot be saved, since their points are no longer in the order of the input.
+		 */
+		template<ranges::contiguous_range Points_rng>
+		inline void save(const std::filesystem::path & path, const Points_rng & points,
+		                 const std::uint64_t fingerprint) const
+		{
+			if (base_ and not file_)
+			{
+				throw std::logic_error("chs::DenseCSR: maps built with REORDER cannot be saved");
+			}
+
+			const auto   offsets = this->offsets();
+			const auto   n       = static_cast<std::size_t>(offsets.back());
+			const auto * first   = ranges::data(points);
+
+			FileHeader header{};
+			std::copy_n(FILE_MAGIC, sizeof(header.magic), header.magic);
+			header.version     = FILE_VERSION;
+			header.dim         = Dim;
+			header.index_size  = sizeof(Index_type);
+			header.sorted_z    = sorted_z_;
+			header.fingerprint = fingerprint;
+			header.num_points  = n;
+			header.num_cells   = offsets.size() - 1;
+			[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+				((header.sizes[Is] = std::get<Is>(sizes_), header.resolutions[Is] = std::get<Is>(resolutions_)), ...);
+			}(std::make_index_sequence<Dim>{});
+			for (std::size_t d = 0; d < 3; d++)
+			{
+				header.box_min[d] = box_.min()[d];
+				header.box_max[d] = box_.max()[d];
+			}
+
+			std::vector<Index_type> indices(n);
+			for (std::size_t i = 0; i < n; i++)
+			{
+				indices[i] = file_ ? file_indices_[i] : static_cast<Index_type>(points_[i] - first);
+			}
+
+			// Written aside and renamed, so that a run reading the file never sees half of it
+			auto tmp = path;
+			tmp += ".tmp";
+			{
+				std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+				out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+				out.write(reinterpret_cast<const char *>(offsets.data()),
+				          static_cast<std::streamsize>(offsets.size_bytes()));
+				out.write(reinterpret_cast<const char *>(indices.data()),
+				          static_cast<std::streamsize>(indices.size() * sizeof(Index_type)));
+				if (not out) { throw std::runtime_error("chs::DenseCSR: cannot write " + tmp.string()); }
+			}
+			std::filesystem::rename(tmp, path);
+		}
+
+		/**
+		 * @brief Maps a file written by save() for these points, which must be read in the same order as the ones it
+		 * was saved for. Offsets and indices are checked in one pass over the file before they are trusted.
+		 * @return The map, or nothing if the file is missing, malformed, or was saved for another input (fingerprint)
+		 * or number of points
+		 */
+		template<ranges::contiguous_range Points_rng>
+		[[nodiscard]] static auto load(const std::filesystem::path & path, Points_rng & points,
+		                               const std::uint64_t fingerprint) -> std::optional<DenseCSR>
+		{
+			const auto file = MappedFile::open(path);
+			if (not file or file->size() < sizeof(FileHeader)) { return std::nullopt; }
+
+			FileHeader header;
+			std::memcpy(&header, file->data(), sizeof(header));
+
+			const auto n = static_cast<std::size_t>(ranges::size(points));
+			if (std::memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) != 0 or header.version != FILE_VERSION or
+			    header.dim != Dim or header.index_size != sizeof(Index_type) or header.fingerprint != fingerprint or
+			    header.num_points != n or header.num_cells >= file->size() / sizeof(Index_type) or
+			    file->size() != sizeof(FileHeader) + (header.num_cells + 1 + n) * sizeof(Index_type))
+			{
+				return std::nullopt;
+			}
+
+			DenseCSR map(header);
+			if (std::apply([](const auto... sizes) { return (sizes * ...); }, map.sizes_) != header.num_cells)
+			{
+				return std::nullopt;
+			}
+
+			const auto * data = reinterpret_cast<const Index_type *>(file->data() + sizeof(FileHeader));
+			map.file_         = file;
+			map.file_offsets_ = std::span(data, header.num_cells + 1);
+			map.file_indices_ = std::span(data + header.num_cells + 1, n);
+			map.base_         = ranges::data(points);
+
+			// Cells must cover the points in order, and every index must fall within them, or queries would read
+			// past the points
+			const auto offsets = map.file_offsets_;
+			if (offsets.front() != 0 or offsets.back() != n or
+			    std::adjacent_find(offsets.begin(), offsets.end(), std::greater{}) != offsets.end() or
+			    not std::all_of(map.file_indices_.begin(), map.file_indices_.end(),
+			                    [n](const Index_type i) { return static_cast<std::size_t>(i) < n; }))
+			{
+				return std::nullopt;
+			}
+
+			return map;
+		}
+	};
+} // namespace chs
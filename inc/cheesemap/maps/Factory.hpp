@@ -0,0 +1,206 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+
+#include "cheesemap/kernels/Sphere.hpp"
+
+#include "cheesemap/maps/Dense.hpp"
+#include "cheesemap/maps/DenseCSR.hpp"
+#include "cheesemap/maps/Mixed3D.hpp"
+#include "cheesemap/maps/Sparse.hpp"
+
+#include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/flags.hpp"
+#include "cheesemap/utils/occupancy.hpp"
+#include "cheesemap/utils/tuning.hpp"
+
+namespace chs
+{
+	enum class map_t
+	{
+		AUTO,
+		DENSE,
+		CSR,
+		SPARSE,
+		MIXED3D,
+	};
+
+	[[nodiscard]] inline auto to_string(const map_t type) -> std::string_view
+	{
+		switch (type)
+		{
+			case map_t::DENSE: return "dense";
+			case map_t::CSR: return "csr";
+			case map_t::SPARSE: return "sparse";
+			case map_t::MIXED3D: return "mixed3d";
+			default: return "auto";
+		}
+	}
+
+	[[nodiscard]] inline auto map_from_string(const std::string_view name) -> map_t
+	{
+		if (name == "dense") { return map_t::DENSE; }
+		if (name == "csr") { return map_t::CSR; }
+		if (name == "sparse") { return map_t::SPARSE; }
+		if (name == "mixed3d") { return map_t::MIXED3D; }
+		return map_t::AUTO;
+	}
+
+	/**
+	 * @brief Map type and cell size picked for a set of points, along with the analysis that led to it.
+	 */
+	struct MapChoice
+	{
+		map_t                 type{ map_t::CSR };
+		std::array<double, 3> resolutions{ 1.0, 1.0, 1.0 };
+		Occupancy             occupancy;
+	};
+
+	/**
+	 * @brief Any of the maps the factory can build. Columns (2D) are preferred, since the pipeline queries with
+	 * 3D kernels over 2.5D clouds, unless the vertical spread makes slicing worthwhile. Dense grids are built in CSR
+	 * layout, as the clouds are not modified once the map is built. Allocator_type is used by the maps with a cell
+	 * per vector (dense and sparse).
+	 */
+	template<typename Point_type, typename Allocator_type = std::allocator<Point_type *>>
+	using AnyMap = std::variant<Dense<Point_type, 2, Allocator_type>, DenseCSR<Point_type, 2>,
+	                            Sparse<Point_type, 2, Allocator_type>, Mixed3D<Point_type>>;
+
+	class MapFactory
+	{
+		// Above this ratio of empty cells, most of a dense grid is wasted memory
+		static constexpr double DENSE_MAX_EMPTY_RATIO = 0.5;
+
+		// Above this ratio of empty cells, a dense grid is not worth it even for lightly populated cells
+		static constexpr double SPARSE_MIN_EMPTY_RATIO = 0.9;
+
+		// Points per occupied cell needed to amortise a hash lookup per visited cell
+		static constexpr double SPARSE_MIN_OCCUPANCY = 8.0;
+
+		// Slicing in z must at least halve the candidates tested per query
+		static constexpr double MIXED3D_MAX_VERTICAL_FRACTION = 0.5;
+
+		// Queries timed per candidate cell size when benchmarking
+		static constexpr std::size_t TUNING_SAMPLES = 1024;
+
+		public:
+		/**
+		 * @brief Analyses the cell occupancy of the points and picks the map that suits them best.
+		 *
+		 * @param res Per-axis cell size of the map.
+		 * @param radius Radius of the queries that will be issued against the map.
+		 */
+		template<typename Points_rng>
+		[[nodiscard]] static auto choose(const Points_rng & points, const std::array<double, 3> & res,
+		                                 const double radius) -> MapChoice
+		{
+			MapChoice choice;
+			choice.resolutions = res;
+			choice.occupancy   = chs::occupancy<2>(points, Box::mbb(points), res, radius);
+
+			const auto & occ = choice.occupancy;
+
+			if (occ.z_layers > 2 and occ.vertical_fraction <= MIXED3D_MAX_VERTICAL_FRACTION)
+			{
+				choice.type = map_t::MIXED3D;
+			}
+			else if (occ.empty_ratio() <= DENSE_MAX_EMPTY_RATIO) { choice.type = map_t::CSR; }
+			else if (occ.empty_ratio() >= SPARSE_MIN_EMPTY_RATIO or occ.mean_occupancy() >= SPARSE_MIN_OCCUPANCY)
+			{
+				choice.type = map_t::SPARSE;
+			}
+			else { choice.type = map_t::CSR; }
+
+			return choice;
+		}
+
+		template<typename Points_rng>
+		[[nodiscard]] static auto choose(const Points_rng & points, const double res, const double radius)
+		        -> MapChoice
+		{
+			return choose(points, std::array<double, 3>{ res, res, res }, radius);
+		}
+
+		/**
+		 * @brief Picks the cell sizes for the points from the query cost model of chs::tuning.
+		 *
+		 * @param benchmark Refine the x/y cell size by building a DenseCSR map at a few sizes around the model's and
+		 * timing a sample of the queries on each; the one with the lowest build plus estimated query time wins.
+		 */
+		template<typename Point_type, typename Points_rng>
+		[[nodiscard]] static auto tune(Points_rng & points, const double radius, const bool benchmark = false)
+		        -> std::array<double, 3>
+		{
+			auto res = tuning::resolutions(points, radius);
+			if (not benchmark or points.empty()) { return res; }
+
+			using clock     = std::chrono::steady_clock;
+			using seconds_t = std::chrono::duration<double>;
+
+			const auto box    = Box::mbb(points);
+			const auto stride = std::max<std::size_t>(points.size() / TUNING_SAMPLES, 1);
+			const auto model  = res[0];
+
+			auto best = std::numeric_limits<double>::max();
+			for (const double scale : { 0.5, 0.71, 1.0, 1.41, 2.0 })
+			{
+				auto candidate = res;
+				candidate[0] = candidate[1] = model * scale;
+				if (not tuning::within_budget<2>(box, candidate, points.size())) { continue; }
+
+				const auto start = clock::now();
+				DenseCSR<Point_type, 2> map(points, std::make_tuple(candidate[0], candidate[1]));
+				const auto built = clock::now();
+
+				std::size_t queries = 0, found = 0;
+				for (std::size_t i = 0; i < points.size(); i += stride, queries++)
+				{
+					kernels::Sphere<3> search(points[i], radius);
+					found += map.query(search).size();
+				}
+				const auto end = clock::now();
+
+				const auto per_query = seconds_t(end - built).count() / static_cast<double>(queries);
+				const auto estimate  = seconds_t(built - start).count() + per_query * static_cast<double>(points.size());
+				if (found > 0 and estimate < best)
+				{
+					best   = estimate;
+					res[0] = res[1] = candidate[0];
+				}
+			}
+
+			return res;
+		}
+
+		template<typename Point_type, typename Allocator_type = std::allocator<Point_type *>, typename Points_rng>
+		[[nodiscard]] static auto make(Points_rng & points, const MapChoice & choice,
+		                               const chs::flags::build::flags_t flags = {}, const Allocator_type & alloc = {})
+		        -> AnyMap<Point_type, Allocator_type>
+		{
+			using Any_type    = AnyMap<Point_type, Allocator_type>;
+			using Dense_type  = Dense<Point_type, 2, Allocator_type>;
+			using Sparse_type = Sparse<Point_type, 2, Allocator_type>;
+
+			const auto & [x, y, z] = choice.resolutions;
+			switch (choice.type)
+			{
+				case map_t::SPARSE:
+					return Any_type{ std::in_place_type<Sparse_type>, points, std::make_tuple(x, y), flags, alloc };
+				case map_t::MIXED3D:
+					return Any_type{ std::in_place_type<Mixed3D<Point_type>>, points,
+						             std::make_tuple(x, y, z), flags };
+				case map_t::DENSE:
+					return Any_type{ std::in_place_type<Dense_type>, points, std::make_tuple(x, y), flags, alloc };
+				default:
+					return Any_type{ std::in_place_type<DenseCSR<Point_type, 2>>, points, std::make_tuple(x, y), flags };
+			}
+		}
+	};
+} // namespace chs
@@ -14,6 +14,7 @@
 #include "cheesemap/utils/flags.hpp"
 #include "cheesemap/utils/sorted_vector.hpp"
 #include "cheesemap/utils/type_traits.hpp"
+#include "cheesemap/utils/zsort.hpp"
 
 namespace chs
 {
@@ -57,12 +58,24 @@ namespace chs
 				else { std::sort(points.begin(), points.end(), cmp); }
 			}
 
+			if constexpr (ranges::random_access_range<Points_rng>)
+			{
+				if (flags & chs::flags::build::PARALLEL)
+				{
+					slice_.add_points(points, true);
+					if (flags & chs::flags::build::SHRINK_TO_FIT) { slice_.shrink_to_fit(); }
+					if (flags & chs::flags::build::SORT_Z) { slice_.sort_z(true); }
+					return;
+				}
+			}
+
 			for (auto & point : points)
 			{
 				slice_.add_point(point);
 			}
 
 			if (flags & chs::flags::build::SHRINK_TO_FIT) { slice_.shrink_to_fit(); }
+			if (flags & chs::flags::build::SORT_Z) { slice_.sort_z(); }
 		}
 
 		template<chs::concepts::Kernel<chs::Point> Kernel_t>
@@ -84,7 +97,12 @@ namespace chs
 			{
 				const auto & cell_opt = slice_.at(indices);
 				if (not cell_opt.has_value()) { continue; }
-				for (auto * point_ptr : cell_opt->get())
+				const auto & cell        = cell_opt->get();
+				const auto [first, last] = slice_.sorted_z() and chs::bounds_z<decltype(kernel)>
+				                                   ? chs::z_range(cell.begin(), cell.end(), kernel.box().min()[2],
+				                                                  kernel.box().max()[2])
+				                                   : std::pair{ cell.begin(), cell.end() };
+				for (auto * point_ptr : ranges::subrange(first, last))
 				{
 					if (kernel.is_inside(*point_ptr) and filter(*point_ptr))
 					{
@@ -93,6 +111,8 @@ namespace chs
 				}
 			}
 
+			if constexpr (chs::concepts::SelectingKernel<Kernel_t, Point_type>) { kernel.select(points); }
+
 			return points;
 		}
 
@@ -189,5 +209,9 @@ namespace chs
 		}
 
 		[[nodiscard]] inline auto mem_footprint() const { return sizeof(*this) + slice_.mem_footprint(); }
+
+		[[nodiscard]] inline auto get_num_cells() const { return slice_.size(); }
+
+		[[nodiscard]] inline auto get_empty_cells() const { return slice_.size() - slice_.occupied(); }
 	};
 } // namespace chs
\ No newline at end of file
@@ -2,14 +2,18 @@
 
 #include <array>
 #include <execution>
+#include <optional>
 #include <vector>
 
 #include <range/v3/all.hpp>
 
 #include "cheesemap/utils/Box.hpp"
 #include "cheesemap/utils/Cell.hpp"
+#include "cheesemap/utils/bucketing.hpp"
 #include "cheesemap/utils/flags.hpp"
+#include "cheesemap/utils/sorted_vector.hpp"
 #include "cheesemap/utils/type_traits.hpp"
+#include "cheesemap/utils/updates.hpp"
 
 #include "cheesemap/concepts/concepts.hpp"
 
@@ -40,6 +44,9 @@ namespace chs
 
 		std::vector<chs::slice::Smart<Point_type>> slices_;
 
+		// Slot of every point in its cell (DYNAMIC)
+		std::optional<PointSlots<Point_type>> slots_;
+
 		template<std::size_t... Is>
 		[[nodiscard]] inline auto idx2box(const auto & idx, std::index_sequence<Is...>) const
 		{
@@ -94,6 +101,55 @@ namespace chs
 			return indices2global(indices, std::make_index_sequence<Dim>{});
 		}
 
+		// One empty slice per cell along z
+		inline void make_slices()
+		{
+			slices_.clear();
+			for (const auto k : ranges::views::indices(std::get<2>(sizes_)))
+			{
+				const auto box_min = idx2box(indices_type{ 0, 0, k });
+				const auto box_max =
+				        idx2box(indices_type(std::get<0>(sizes_) - 1, std::get<1>(sizes_) - 1, k + 1));
+
+				Box slice_box{ std::make_pair(box_min.min(), box_max.max()) };
+				slices_.emplace_back(slice_box, std::make_tuple(std::get<0>(resolutions_),
+				                                                std::get<1>(resolutions_)));
+			}
+		}
+
+		[[nodiscard]] inline auto slots() -> PointSlots<Point_type> * { return slots_ ? &*slots_ : nullptr; }
+
+		// With DYNAMIC, records the slot of every point in its cell
+		inline void index_slots(const chs::flags::build::flags_t flags)
+		{
+			if (not(flags & chs::flags::build::DYNAMIC)) { return; }
+
+			slots_.emplace();
+			for (const auto & slice : slices_)
+			{
+				slice.for_each_cell([&](const auto & cell) {
+					for (std::size_t s = 0; s < cell.size(); s++) { slots_->set(cell[s], s); }
+				});
+			}
+		}
+
+		inline void place(Point_type & point) { slices_[std::get<2>(coord2indices(point))].add_point(point, slots()); }
+
+		// Grows the grid to hold box, placing its points again in the slices and cells they fall in now
+		inline void extend(const Box & box)
+		{
+			if (not chs::extend_grid<Dim>(box_, sizes_, resolutions_, box)) { return; }
+
+			std::vector<Point_type *> points;
+			for (const auto & slice : slices_)
+			{
+				slice.for_each_cell([&](const auto & cell) { points.insert(points.end(), cell.begin(), cell.end()); });
+			}
+
+			make_slices();
+			for (auto * point : points) { place(*point); }
+		}
+
 		public:
 		Mixed3D() = default;
 
@@ -116,16 +172,7 @@ namespace chs
 			}(std::make_index_sequence<Dim>{});
 
 			// Generate the slices
-			for (const auto k : ranges::views::indices(std::get<2>(sizes_)))
-			{
-				const auto box_min = idx2box(indices_type{ 0, 0, k });
-				const auto box_max =
-				        idx2box(indices_type(std::get<0>(sizes_) - 1, std::get<1>(sizes_) - 1, k + 1));
-
-				Box slice_box{ std::make_pair(box_min.min(), box_max.max()) };
-				slices_.emplace_back(slice_box, std::make_tuple(std::get<0>(resolutions_),
-				                                                std::get<1>(resolutions_)));
-			}
+			make_slices();
 
 			// Sort points by global idx (should improve locality when querying)
 			if (flags & chs::flags::build::REORDER)
@@ -140,6 +187,34 @@ namespace chs
 			}
 
 			// Add the points to the slices
+			if constexpr (ranges::random_access_range<Points_rng>)
+			{
+				if (flags & chs::flags::build::PARALLEL)
+				{
+					// Group the points by slice with a counting sort and build the slices independently
+					auto       first   = ranges::begin(points);
+					const auto buckets = chs::bucket<std::size_t>(
+					        static_cast<std::size_t>(ranges::distance(points)), slices_.size(),
+					        [&](const std::size_t i) { return std::get<2>(coord2indices(first[i])); }, true);
+
+					#pragma omp parallel for schedule(dynamic, 1)
+					for (std::size_t k = 0; k < slices_.size(); k++)
+					{
+						slices_[k].add_points(
+						        ranges::subrange(buckets.order.begin() + buckets.offsets[k],
+						                         buckets.order.begin() + buckets.offsets[k + 1]) |
+						        ranges::views::transform([&](const std::size_t i) -> Point_type & { return first[i]; }));
+					}
+
+					if (flags & chs::flags::build::SHRINK_TO_FIT)
+					{
+						ranges::for_each(slices_, [](auto & slice) { slice.shrink_to_fit(); });
+					}
+					index_slots(flags);
+					return;
+				}
+			}
+
 			for (auto & point : points)
 			{
 				const auto [i, j, k] = coord2indices(point);
@@ -150,6 +225,34 @@ namespace chs
 			{
 				ranges::for_each(slices_, [](auto & slice) { slice.shrink_to_fit(); });
 			}
+			index_slots(flags);
+		}
+
+		/**
+		 * @brief Adds the points to the map, first growing it if some fall outside its box. As the points the map was
+		 * built on, they must stay where they are while in it.
+		 */
+		template<ranges::range Points_rng>
+		inline void insert(Points_rng & points)
+		{
+			extend(Box::mbb(points));
+			for (auto & point : points) { place(point); }
+		}
+
+		inline void insert(Point_type & point)
+		{
+			extend(Box(std::make_pair(Point(point), Point(point))));
+			place(point);
+		}
+
+		/**
+		 * @brief Takes the point out of the map, filling its slot with the last point of its cell. The point must have
+		 * the coordinates it was added with.
+		 * @return Whether the point was in the map
+		 */
+		inline auto remove(const Point_type & point) -> bool
+		{
+			return slices_[std::get<2>(coord2indices(point))].remove_point(point, slots());
 		}
 
 		template<chs::concepts::Kernel<chs::Point> Kernel_t>
@@ -187,6 +290,8 @@ namespace chs
 				}
 			}
 
+			if constexpr (chs::concepts::SelectingKernel<Kernel_t, Point_type>) { kernel.select(points); }
+
 			return points;
 		}
 
@@ -290,8 +395,20 @@ namespace chs
 
 		[[nodiscard]] inline auto mem_footprint() const
 		{
-			return ranges::accumulate(slices_, sizeof(*this), [](auto acc, const auto & slice) {
-				return acc + slice.mem_footprint();
+			return ranges::accumulate(slices_, sizeof(*this) + (slots_ ? slots_->mem_footprint() : 0),
+			                          [](auto acc, const auto & slice) { return acc + slice.mem_footprint(); });
+		}
+
+		[[nodiscard]] inline auto get_num_cells() const
+		{
+			return ranges::accumulate(slices_, std::size_t{ 0 },
+			                          [](auto acc, const auto & slice) { return acc + slice.size(); });
+		}
+
+		[[nodiscard]] inline auto get_empty_cells() const
+		{
+			return ranges::accumulate(slices_, std::size_t{ 0 }, [](auto acc, const auto & slice) {
+				return acc + slice.size() - slice.occupied();
 			});
 		}
 	};
@@ -6,7 +6,11 @@
 
 #include "cheesemap/utils/Box.hpp"
 #include "cheesemap/utils/Cell.hpp"
+#include "cheesemap/utils/bucketing.hpp"
+#include "cheesemap/utils/flat_map.hpp"
 #include "cheesemap/utils/type_traits.hpp"
+#include "cheesemap/utils/updates.hpp"
+#include "cheesemap/utils/zsort.hpp"
 
 namespace chs::slice
 {
@@ -35,7 +39,7 @@ namespace chs::slice
 		indices_type sizes_;
 
 		// Cells of the map (using sparse representation)
-		std::unordered_map<std::size_t, cell_type> cells_sparse_;
+		chs::FlatMap<cell_type> cells_sparse_;
 
 		// Cells of the map (using dense representation)
 		std::vector<cell_type> cells_dense_;
@@ -43,26 +47,21 @@ namespace chs::slice
 		// Use sparse
 		bool use_sparse_ = true;
 
-		inline void add_point_dense(Point_type & point)
+		// Points of each cell kept sorted by z
+		bool sorted_z_ = false;
+
+		inline void add_point_dense(Point_type & point, PointSlots<Point_type> * slots)
 		{
 			const auto [i, j] = coord2indices(point);
 			const auto idx    = i * std::get<1>(sizes_) + j;
-			cells_dense_[idx].emplace_back(&point);
+			chs::cell_insert(cells_dense_[idx], &point, sorted_z_, slots);
 		}
 
-		inline void add_point_sparse(Point_type & point)
+		inline void add_point_sparse(Point_type & point, PointSlots<Point_type> * slots)
 		{
 			const auto idx = indices2global(coord2indices(point));
 
-			auto cells_it = cells_sparse_.find(idx);
-
-			if (cells_it == cells_sparse_.end())
-			{
-				cells_sparse_.emplace(idx, cell_type{});
-				cells_it = cells_sparse_.find(idx);
-			}
-
-			cells_it->second.emplace_back(&point);
+			chs::cell_insert(cells_sparse_[idx], &point, sorted_z_, slots);
 
 			if (density() > SPARSE_TO_DENSE_THRESHOLD) { sparse2dense(); }
 		}
@@ -116,8 +115,8 @@ namespace chs::slice
 		Smart(const Box & box, const dimensions_type & res) :
 		        resolutions_(res),
 		        box_(box),
-		        sizes_({ static_cast<std::size_t>(std::ceil((box.max()[0] - box.min()[0]) / std::get<0>(res))),
-		                 static_cast<std::size_t>(std::ceil((box.max()[1] - box.min()[1]) / std::get<1>(res))) })
+		        sizes_({ static_cast<std::size_t>(std::floor((box.max()[0] - box.min()[0]) / std::get<0>(res))) + 1,
+		                 static_cast<std::size_t>(std::floor((box.max()[1] - box.min()[1]) / std::get<1>(res))) + 1 })
 		{}
 
 		template<typename Points_rng>
@@ -132,6 +131,8 @@ namespace chs::slice
 
 		[[nodiscard]] inline auto sparse() const { return use_sparse_; }
 
+		[[nodiscard]] inline auto sorted_z() const { return sorted_z_; }
+
 		[[nodiscard]] inline auto resolutions() const -> const auto & { return resolutions_; }
 
 		[[nodiscard]] inline auto resolutions() { return resolutions_; }
@@ -140,6 +141,13 @@ namespace chs::slice
 
 		[[nodiscard]] inline auto size() const { return std::get<0>(sizes_) * std::get<1>(sizes_); }
 
+		[[nodiscard]] inline auto occupied() const
+		{
+			if (use_sparse_) { return cells_sparse_.size(); }
+			return static_cast<std::size_t>(
+			        ranges::count_if(cells_dense_, [](const auto & cell) { return not cell.empty(); }));
+		}
+
 		[[nodiscard]] inline auto density() const
 		{
 			if (use_sparse_)
@@ -193,10 +201,124 @@ namespace chs::slice
 			return idx2box(idx, std::make_index_sequence<Dim>{});
 		}
 
-		inline void add_point(Point_type & point)
+		/**
+		 * @brief Adds the point, recording the slots that change in slots if given
+		 */
+		inline void add_point(Point_type & point, PointSlots<Point_type> * slots = nullptr)
+		{
+			if (use_sparse_) { add_point_sparse(point, slots); }
+			else { add_point_dense(point, slots); }
+		}
+
+		/**
+		 * @brief Takes the point out of its cell, dropping the cell if it is sparse and ends up empty. The slice stays
+		 * dense once it is.
+		 * @return Whether the point was in the slice
+		 */
+		inline auto remove_point(const Point_type & point, PointSlots<Point_type> * slots = nullptr) -> bool
+		{
+			const auto idx = indices2global(coord2indices(point));
+
+			if (not use_sparse_) { return chs::cell_remove(cells_dense_[idx], &point, sorted_z_, slots); }
+
+			const auto cell_it = cells_sparse_.find(idx);
+			if (cell_it == cells_sparse_.end() or not chs::cell_remove(cell_it->second, &point, sorted_z_, slots))
+			{
+				return false;
+			}
+			if (cell_it->second.empty()) { cells_sparse_.erase(idx); }
+			return true;
+		}
+
+		// Calls fn with every cell holding points
+		inline void for_each_cell(auto && fn) const
 		{
-			if (use_sparse_) { add_point_sparse(point); }
-			else { add_point_dense(point); }
+			if (use_sparse_)
+			{
+				for (const auto & [idx, cell] : cells_sparse_) { fn(cell); }
+			}
+			else
+			{
+				for (const auto & cell : cells_dense_)
+				{
+					if (not cell.empty()) { fn(cell); }
+				}
+			}
+		}
+
+		/**
+		 * @brief Adds all the points at once: they are grouped by cell sorting on the global index and each cell is
+		 * filled in one go. Ends up in the same representation as adding them one by one, since the density only
+		 * grows.
+		 */
+		template<typename Points_rng>
+		        requires ranges::random_access_range<Points_rng>
+		inline void add_points(Points_rng && points, const bool parallel = false)
+		{
+			auto       first  = ranges::begin(points);
+			const auto groups = chs::group<std::size_t>(
+			        static_cast<std::size_t>(ranges::distance(points)),
+			        [&](const std::size_t i) { return indices2global(coord2indices(first[i])); }, parallel);
+
+			const auto num_groups = groups.keys.size();
+
+			std::vector<cell_type> cells(num_groups);
+
+			#pragma omp parallel for schedule(dynamic, 256) if (parallel)
+			for (std::size_t g = 0; g < num_groups; g++)
+			{
+				cells[g].reserve(groups.offsets[g + 1] - groups.offsets[g]);
+				for (auto i = groups.offsets[g]; i < groups.offsets[g + 1]; i++)
+				{
+					cells[g].emplace_back(&first[groups.order[i]]);
+				}
+			}
+
+			const auto merge = [&](cell_type & cell, cell_type && added) {
+				if (cell.empty()) { cell = std::move(added); }
+				else { cell.insert(cell.end(), added.begin(), added.end()); }
+				if (sorted_z_) { chs::sort_z(cell.begin(), cell.end()); }
+			};
+
+			if (use_sparse_)
+			{
+				cells_sparse_.reserve(cells_sparse_.size() + num_groups);
+				for (std::size_t g = 0; g < num_groups; g++)
+				{
+					merge(cells_sparse_[groups.keys[g]], std::move(cells[g]));
+				}
+				if (density() > SPARSE_TO_DENSE_THRESHOLD) { sparse2dense(); }
+			}
+			else
+			{
+				#pragma omp parallel for schedule(dynamic, 256) if (parallel)
+				for (std::size_t g = 0; g < num_groups; g++)
+				{
+					merge(cells_dense_[groups.keys[g]], std::move(cells[g]));
+				}
+			}
+		}
+
+		/**
+		 * @brief Sorts the points of every cell by z, so that queries only test the ones within the height of their
+		 * kernel, and keeps them sorted as more points are added
+		 */
+		inline void sort_z(const bool parallel = false)
+		{
+			sorted_z_ = true;
+
+			std::vector<cell_type *> cells;
+			if (use_sparse_)
+			{
+				for (auto & [idx, cell] : cells_sparse_) { cells.push_back(&cell); }
+			}
+			else
+			{
+				for (auto & cell : cells_dense_) { cells.push_back(&cell); }
+			}
+
+			#pragma omp parallel for schedule(dynamic, 256) if (parallel)
+			for (std::size_t c = 0; c < cells.size(); c++) { chs::sort_z(cells[c]->begin(), cells[c]->end()); }
 		}
 
 		inline void shrink_to_fit()
@@ -251,13 +373,7 @@ namespace chs::slice
 
 			if (use_sparse_)
 			{
-				// From https://stackoverflow.com/a/25438497
-				bytes +=
-				        // data list: #elements * (bucket size + pointers to next)
-				        (cells_sparse_.size() * (sizeof(typename decltype(cells_sparse_)::value_type) +
-				                                 sizeof(void *)) +
-				         // bucket index: #buckets * (pointer to bucket + size)
-				         cells_sparse_.bucket_count() * (sizeof(void *) + sizeof(size_t)));
+				bytes += cells_sparse_.mem_footprint() - sizeof(cells_sparse_);
 
 				for (const auto & [idx, cell] : cells_sparse_)
 				{
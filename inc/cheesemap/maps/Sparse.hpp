@@ -2,7 +2,8 @@
 
 #include <array>
 #include <execution>
-#include <unordered_map>
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include <range/v3/all.hpp>
@@ -12,21 +13,31 @@
 
 #include "cheesemap/concepts/concepts.hpp"
 
+#include "cheesemap/utils/bucketing.hpp"
 #include "cheesemap/utils/Cartesian.hpp"
 #include "cheesemap/utils/flags.hpp"
+#include "cheesemap/utils/flat_map.hpp"
 #include "cheesemap/utils/sorted_vector.hpp"
 #include "cheesemap/utils/type_traits.hpp"
+#include "cheesemap/utils/updates.hpp"
+#include "cheesemap/utils/zsort.hpp"
 
 namespace chs
 {
-	template<typename Point_type, std::size_t Dim = 3>
+	/**
+	 * @brief Hash map from global cell index to the points of the cell, for grids with mostly empty cells. Cells and
+	 * the slots of the map are allocated with Allocator_type.
+	 */
+	template<typename Point_type, std::size_t Dim = 3, typename Allocator_type = std::allocator<Point_type *>>
 	class Sparse
 	{
 		protected:
 		using resolution_type = double;
 		using dimensions_type = chs::type_traits::tuple<resolution_type, Dim>;
 		using indices_type    = chs::type_traits::tuple<std::size_t, Dim>;
-		using cell_type       = Cell<Point_type>;
+		using cell_type       = Cell<Point_type, Allocator_type>;
+		using entry_type      = std::pair<std::size_t, cell_type>;
+		using cells_allocator = typename std::allocator_traits<Allocator_type>::template rebind_alloc<entry_type>;
 
 		static constexpr dimensions_type DEFAULT_RESOLUTIONS = chs::n_tuple<Dim>(resolution_type{ 1 });
 
@@ -40,7 +51,13 @@ namespace chs
 		indices_type sizes_;
 
 		// Cells of the map
-		std::unordered_map<std::size_t, cell_type> cells_;
+		chs::FlatMap<cell_type, cells_allocator> cells_;
+
+		// Points of each cell sorted by z (SORT_Z, only 2D maps, whose cells span the whole height)
+		bool sorted_z_{};
+
+		// Slot of every point in its cell (DYNAMIC)
+		std::optional<PointSlots<Point_type>> slots_;
 
 		template<std::size_t... Is>
 		[[nodiscard]] inline auto indices2global(const auto & indices, std::index_sequence<Is...>) const
@@ -100,18 +117,54 @@ namespace chs
 
 		[[nodiscard]] inline auto & at(const auto & indices) const { return cells_[indices2global(indices)]; }
 
+		[[nodiscard]] inline auto slots() -> PointSlots<Point_type> * { return slots_ ? &*slots_ : nullptr; }
+
+		// With DYNAMIC, records the slot of every point in its cell
+		inline void index_slots(const chs::flags::build::flags_t flags)
+		{
+			if (not(flags & chs::flags::build::DYNAMIC)) { return; }
+
+			slots_.emplace();
+			for (const auto & [idx, cell] : cells_)
+			{
+				for (std::size_t s = 0; s < cell.size(); s++) { slots_->set(cell[s], s); }
+			}
+		}
+
+		inline void place(Point_type & point)
+		{
+			chs::cell_insert(cells_[indices2global(coord2indices(point))], &point, sorted_z_, slots());
+		}
+
+		// Grows the grid to hold box, placing its points again in the cells they fall in now
+		inline void extend(const Box & box)
+		{
+			if (not chs::extend_grid<Dim>(box_, sizes_, resolutions_, box)) { return; }
+
+			auto old = std::exchange(cells_, decltype(cells_)(cells_.get_allocator()));
+			cells_.reserve(old.size());
+			for (auto & [idx, cell] : old)
+			{
+				for (auto * point : cell) { place(*point); }
+			}
+		}
+
 		public:
 		Sparse() = delete;
 
 		template<typename Points_rng>
-		Sparse(Points_rng & points, const resolution_type res, const chs::flags::build::flags_t flags = {}) :
-		        Sparse(points, dimensions_type(n_tuple<Dim>(res)), flags)
+		Sparse(Points_rng & points, const resolution_type res, const chs::flags::build::flags_t flags = {},
+		       const Allocator_type & alloc = {}) :
+		        Sparse(points, dimensions_type(n_tuple<Dim>(res)), flags, alloc)
 		{}
 
 		template<typename Points_rng>
-		Sparse(Points_rng & points, dimensions_type res, const chs::flags::build::flags_t flags = {}) :
-		        resolutions_(res), box_(Box::mbb(points))
+		Sparse(Points_rng & points, dimensions_type res, const chs::flags::build::flags_t flags = {},
+		       const Allocator_type & alloc = {}) :
+		        resolutions_(res), box_(Box::mbb(points)), cells_(cells_allocator(alloc))
 		{
+			if constexpr (Dim == 2) { sorted_z_ = (flags & chs::flags::build::SORT_Z) != 0; }
+
 			// Number of cells in each dimension
 			[&]<std::size_t... Is>(std::index_sequence<Is...>) {
 				((std::get<Is>(sizes_) =
@@ -133,6 +186,43 @@ namespace chs
 				else { std::sort(points.begin(), points.end(), cmp); }
 			}
 
+			if constexpr (ranges::random_access_range<Points_rng>)
+			{
+				if (flags & chs::flags::build::PARALLEL)
+				{
+					// Group the points by cell sorting on the global index, insert every cell in the map in one pass
+					// sized for all of them (so no slot moves afterwards) and fill the cells in parallel
+					auto       first  = ranges::begin(points);
+					const auto groups = chs::group<std::size_t>(
+					        static_cast<std::size_t>(ranges::distance(points)),
+					        [&](const std::size_t i) { return indices2global(coord2indices(first[i])); }, true);
+
+					const auto num_groups = groups.keys.size();
+
+					cells_.reserve(num_groups);
+					std::vector<cell_type *> cells(num_groups);
+					for (std::size_t g = 0; g < num_groups; g++)
+					{
+						cells[g] = &cells_.try_emplace(groups.keys[g], Allocator_type(cells_.get_allocator()))
+						                    .first->second;
+					}
+
+					#pragma omp parallel for schedule(dynamic, 256)
+					for (std::size_t g = 0; g < num_groups; g++)
+					{
+						auto & cell = *cells[g];
+						cell.reserve(groups.offsets[g + 1] - groups.offsets[g]);
+						for (auto i = groups.offsets[g]; i < groups.offsets[g + 1]; i++)
+						{
+							cell.emplace_back(&first[groups.order[i]]);
+						}
+						if (sorted_z_) { chs::sort_z(cell.begin(), cell.end()); }
+					}
+					index_slots(flags);
+					return;
+				}
+			}
+
 			for (auto & point : points)
 			{
 				const auto indices = coord2indices(point);
@@ -146,6 +236,46 @@ namespace chs
 			{
 				ranges::for_each(cells_, [](auto & cell) { cell.second.shrink_to_fit(); });
 			}
+			if (sorted_z_)
+			{
+				ranges::for_each(cells_, [](auto & cell) { chs::sort_z(cell.second.begin(), cell.second.end()); });
+			}
+			index_slots(flags);
+		}
+
+		/**
+		 * @brief Adds the points to the map, first growing it if some fall outside its box. As the points the map was
+		 * built on, they must stay where they are while in it.
+		 */
+		template<ranges::range Points_rng>
+		inline void insert(Points_rng & points)
+		{
+			extend(Box::mbb(points));
+			for (auto & point : points) { place(point); }
+		}
+
+		inline void insert(Point_type & point)
+		{
+			extend(Box(std::make_pair(Point(point), Point(point))));
+			place(point);
+		}
+
+		/**
+		 * @brief Takes the point out of the map, filling its slot with the last point of its cell, and drops the cell
+		 * if it ends up empty. The point must have the coordinates it was added with.
+		 * @return Whether the point was in the map
+		 */
+		inline auto remove(const Point_type & point) -> bool
+		{
+			const auto global_idx = indices2global(coord2indices(point));
+			const auto cell_it    = cells_.find(global_idx);
+
+			if (cell_it == cells_.end() or not chs::cell_remove(cell_it->second, &point, sorted_z_, slots()))
+			{
+				return false;
+			}
+			if (cell_it->second.empty()) { cells_.erase(global_idx); }
+			return true;
 		}
 
 		template<chs::concepts::Kernel<chs::Point> Kernel_t>
@@ -170,14 +300,20 @@ namespace chs
 
 				if (cell_it == cells_.end()) { continue; }
 
-				const auto & cell = cell_it->second;
+				const auto & cell        = cell_it->second;
+				const auto [first, last] = sorted_z_ and chs::bounds_z<decltype(kernel)>
+				                                   ? chs::z_range(cell.begin(), cell.end(), kernel.box().min()[2],
+				                                                  kernel.box().max()[2])
+				                                   : std::pair{ cell.begin(), cell.end() };
 
-				for (const auto & point : cell)
+				for (const auto & point : ranges::subrange(first, last))
 				{
 					if (kernel.is_inside(*point) and filter(*point)) { points.emplace_back(point); }
 				}
 			}
 
+			if constexpr (chs::concepts::SelectingKernel<Kernel_t, Point_type>) { kernel.select(points); }
+
 			return points;
 		}
 
@@ -282,21 +418,26 @@ namespace chs
 
 		[[nodiscard]] inline auto mem_footprint() const
 		{
-			std::size_t bytes = sizeof(*this);
-
-			// From https://stackoverflow.com/a/25438497
-			bytes +=
-			        // data list: #elements * (bucket size + pointers to next)
-			        (cells_.size() * (sizeof(typename decltype(cells_)::value_type) + sizeof(void *)) +
-			         // bucket index: #buckets * (pointer to bucket + size)
-			         cells_.bucket_count() * (sizeof(void *) + sizeof(size_t)));
+			std::size_t bytes = sizeof(*this) - sizeof(cells_) + cells_.mem_footprint();
 
 			for (const auto & [idx, cell] : cells_)
 			{
 				bytes += cell.capacity() * sizeof(Point_type *);
 			}
+			if (slots_) { bytes += slots_->mem_footprint(); }
 
 			return bytes;
 		}
+
+		[[nodiscard]] inline auto get_num_cells() const
+		{
+			return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+				std::size_t acc = 1;
+				((acc *= std::get<Is>(sizes_)), ...);
+				return acc;
+			}(std::make_index_sequence<Dim>{});
+		}
+
+		[[nodiscard]] inline auto get_empty_cells() const { return get_num_cells() - cells_.size(); }
 	};
 } // namespace chs
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <range/v3/all.hpp>
+
+#include "cheesemap/kernels/Sphere.hpp"
+#include "cheesemap/utils/bucketing.hpp"
+#include "cheesemap/utils/parallel.hpp"
+#include "cheesemap/utils/stats.hpp"
+
+namespace chs
+{
+	/**
+	 * @brief Feedback used to adapt the radius of consecutive queries towards a target number of neighbours.
+	 * After each query the radius moves by (target - found) * sensitivity, at most max_step, and is kept in
+	 * [min_radius, max_radius]. max_step and sensitivity are lengths, so they are scaled with the radii.
+	 */
+	struct Adaptive
+	{
+		std::size_t target{};
+		double      min_radius{};
+		double      max_radius{};
+		double      max_step{ 0.25 };
+		double      sensitivity{ 0.001 };
+
+		[[nodiscard]] inline auto next(const double radius, const std::size_t found) const -> double
+		{
+			const double step = (static_cast<double>(target) - static_cast<double>(found)) * sensitivity;
+			return std::clamp(radius + std::clamp(step, -max_step, max_step), min_radius, max_radius);
+		}
+	};
+
+	// Spreads the lower 21 bits of v so there are two zero bits between each of them
+	[[nodiscard]] inline constexpr auto spread_bits(std::uint64_t v) -> std::uint64_t
+	{
+		v &= 0x1fffff;
+		v = (v | v << 32) & 0x1f00000000ffff;
+		v = (v | v << 16) & 0x1f0000ff0000ff;
+		v = (v | v << 8) & 0x100f00f00f00f00f;
+		v = (v | v << 4) & 0x10c30c30c30c30c3;
+		v = (v | v << 2) & 0x1249249249249249;
+		return v;
+	}
+
+	/**
+	 * @brief Indices of the points sorted along a Z-order curve over cells of the given size, so that consecutive
+	 * indices are close in space.
+	 */
+	template<ranges::random_access_range Points_rng>
+	[[nodiscard]] inline auto spatial_order(const Points_rng & points, const double cell, const bool parallel = false)
+	        -> std::vector<std::size_t>
+	{
+		const auto first = ranges::begin(points);
+		const auto n     = static_cast<std::size_t>(ranges::distance(points));
+
+		double min_x = std::numeric_limits<double>::max();
+		double min_y = min_x, min_z = min_x;
+
+		#pragma omp parallel for if (parallel) reduction(min : min_x, min_y, min_z)
+		for (std::size_t i = 0; i < n; i++)
+		{
+			min_x = std::min(min_x, static_cast<double>(first[i][0]));
+			min_y = std::min(min_y, static_cast<double>(first[i][1]));
+			min_z = std::min(min_z, static_cast<double>(first[i][2]));
+		}
+
+		const auto key = [&](const std::size_t i) {
+			const auto q = [&](const double v, const double min) {
+				return std::min<std::uint64_t>(0x1fffff, static_cast<std::uint64_t>((v - min) / cell));
+			};
+			return spread_bits(q(first[i][0], min_x)) | spread_bits(q(first[i][1], min_y)) << 1 |
+			       spread_bits(q(first[i][2], min_z)) << 2;
+		};
+
+		return chs::group<std::size_t>(n, key, parallel).order;
+	}
+
+	/**
+	 * @brief Searches the neighbours of every point with a sphere whose radius adapts towards params.target
+	 * neighbours, and calls callback(i, neighbours, radius) with the radius used for points[i]. The callback returns
+	 * how many of the neighbours it kept, e.g. leaving out points[i] itself, which is what the radius adapts to.
+	 *
+	 * Points are visited in spatial order and split in contiguous runs, one at a time per thread, so the radius
+	 * reached by a point is the starting one of the next, which is usually close by and has a similar density.
+	 * Every run starts from the given radius. No query goes beyond params.max_radius. Returns the work done.
+	 */
+	template<typename Map_type, ranges::random_access_range Points_rng, typename Callback_t>
+	inline auto query_adaptive(const Map_type & map, const Points_rng & points, const Adaptive & params,
+	                           const double radius, Callback_t && callback) -> QueryStats
+	{
+		const auto first = ranges::begin(points);
+		const auto n     = static_cast<std::size_t>(ranges::distance(points));
+		const auto order = spatial_order(points, params.max_radius, true);
+
+		const std::size_t runs  = std::min(n, 16 * chs::num_threads());
+		std::size_t       found = 0;
+
+		#pragma omp parallel for schedule(dynamic) reduction(+ : found)
+		for (std::size_t r = 0; r < runs; r++)
+		{
+			double current = std::clamp(radius, params.min_radius, params.max_radius);
+			for (std::size_t k = n * r / runs; k < n * (r + 1) / runs; k++)
+			{
+				const auto i          = order[k];
+				const auto neighbours = map.query(kernels::Sphere<3>(first[i], current));
+				const std::size_t used = callback(i, neighbours, current);
+				current                = params.next(current, used);
+				found += neighbours.size();
+			}
+		}
+
+		return QueryStats{ .queries = n, .found = found };
+	}
+} // namespace chs
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include <range/v3/all.hpp>
+
+#include "cheesemap/utils/stats.hpp"
+
+namespace chs
+{
+	/**
+	 * @brief Runs every kernel of the range against the map and calls callback(i, neighbours) with the points inside
+	 * kernels[i]. Uses the batched query of the map if it has one, otherwise one query per kernel in parallel.
+	 * Returns the work done.
+	 */
+	template<typename Map_type, ranges::random_access_range Kernels_rng, typename Callback_t>
+	inline auto query_batch(const Map_type & map, const Kernels_rng & kernels, Callback_t && callback) -> QueryStats
+	{
+		if constexpr (requires { map.query_batch(kernels, callback); }) { return map.query_batch(kernels, callback); }
+		else
+		{
+			const auto  first = ranges::begin(kernels);
+			const auto  n     = static_cast<std::size_t>(ranges::distance(kernels));
+			std::size_t found = 0;
+
+			#pragma omp parallel for schedule(dynamic, 64) reduction(+ : found)
+			for (std::size_t i = 0; i < n; i++)
+			{
+				const auto neighbours = map.query(first[i]);
+				callback(i, neighbours);
+				found += neighbours.size();
+			}
+
+			return QueryStats{ .queries = n, .found = found };
+		}
+	}
+
+	/**
+	 * @brief Runs every kernel of the range against the map and calls callback(i, count) with the number of points
+	 * inside kernels[i]. Maps with a batched count never gather the points, the rest count the result of a query.
+	 */
+	template<typename Map_type, ranges::random_access_range Kernels_rng, typename Callback_t>
+	inline auto count_batch(const Map_type & map, const Kernels_rng & kernels, Callback_t && callback) -> QueryStats
+	{
+		if constexpr (requires { map.count_batch(kernels, callback); }) { return map.count_batch(kernels, callback); }
+		else
+		{
+			return query_batch(map, kernels, [&](const std::size_t i, const auto & neighbours) {
+				callback(i, static_cast<std::size_t>(ranges::distance(neighbours)));
+			});
+		}
+	}
+} // namespace chs
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <range/v3/all.hpp>
+
+#include "cheesemap/kernels/Sphere.hpp"
+#include "cheesemap/maps/batch.hpp"
+
+namespace chs
+{
+	/**
+	 * @brief Disjoint sets of 0 ... n - 1 that threads can join concurrently without locks. Roots are linked with a
+	 * compare-and-swap, the larger one under the smaller, so every set ends up rooted at its smallest element
+	 * whatever the order of the unions. Finds halve the paths they walk.
+	 */
+	class ConcurrentDisjointSets
+	{
+		std::vector<std::atomic<std::size_t>> parent_;
+
+		public:
+		explicit ConcurrentDisjointSets(const std::size_t n) : parent_(n)
+		{
+			#pragma omp parallel for
+			for (std::size_t i = 0; i < n; i++) { parent_[i].store(i, std::memory_order_relaxed); }
+		}
+
+		[[nodiscard]] inline auto size() const { return parent_.size(); }
+
+		[[nodiscard]] inline auto find(std::size_t i) -> std::size_t
+		{
+			while (true)
+			{
+				auto parent = parent_[i].load(std::memory_order_relaxed);
+				if (parent == i) { return i; }
+
+				const auto grandparent = parent_[parent].load(std::memory_order_relaxed);
+				// Losing this race only means another thread shortened the path first
+				if (grandparent != parent)
+				{
+					parent_[i].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+				}
+				i = grandparent;
+			}
+		}
+
+		/**
+		 * @return Whether a and b were in different sets
+		 */
+		inline auto unite(std::size_t a, std::size_t b) -> bool
+		{
+			while (true)
+			{
+				a = find(a);
+				b = find(b);
+				if (a == b) { return false; }
+				if (a > b) { std::swap(a, b); }
+
+				// b may have been linked by another thread since it was found, then try again from the new roots
+				auto expected = b;
+				if (parent_[b].compare_exchange_strong(expected, a, std::memory_order_acq_rel)) { return true; }
+			}
+		}
+	};
+
+	/**
+	 * @brief Euclidean clustering: points at most distance apart, in the first Dim axes, are in the same cluster,
+	 * and so are chains of them. The range must hold the points the map was built on, contiguous. Points the filter
+	 * rejects take no part: each is a cluster of its own, and never joins others.
+	 *
+	 * Every point queries its sphere in parallel, through the batched query of the map if it has one, and joins the
+	 * neighbours after it in the range to its set.
+	 *
+	 * @return The cluster of every point of the range, as the index of the first point of that cluster
+	 */
+	template<std::size_t Dim = 3, typename Map_type, ranges::contiguous_range Points_rng, typename Filter_t>
+	[[nodiscard]] inline auto euclidean_clusters(const Map_type & map, const Points_rng & points, const double distance,
+	                                             Filter_t && filter) -> std::vector<std::size_t>
+	{
+		const auto   n     = static_cast<std::size_t>(ranges::size(points));
+		const auto * first = ranges::data(points);
+
+		std::vector<std::size_t> kept;
+		kept.reserve(n);
+		for (std::size_t i = 0; i < n; i++)
+		{
+			if (filter(first[i])) { kept.push_back(i); }
+		}
+
+		ConcurrentDisjointSets sets(n);
+		const auto spheres = kept | ranges::views::transform([&](const std::size_t i) {
+			                     return kernels::Sphere<Dim>(first[i], distance);
+		                     });
+
+		// Each pair is found from both of its points, only the first one joins them
+		query_batch(map, spheres, [&](const std::size_t q, const auto & neighbours) {
+			const auto i = kept[q];
+			for (const auto * neighbour : neighbours)
+			{
+				const auto j = static_cast<std::size_t>(neighbour - first);
+				if (j > i and filter(*neighbour)) { sets.unite(i, j); }
+			}
+		});
+
+		std::vector<std::size_t> clusters(n);
+		#pragma omp parallel for
+		for (std::size_t i = 0; i < n; i++) { clusters[i] = sets.find(i); }
+		return clusters;
+	}
+
+	template<std::size_t Dim = 3, typename Map_type, ranges::contiguous_range Points_rng>
+	[[nodiscard]] inline auto euclidean_clusters(const Map_type & map, const Points_rng & points,
+	                                             const double distance) -> std::vector<std::size_t>
+	{
+		const auto all = []([[maybe_unused]] const auto &) { return true; };
+		return euclidean_clusters<Dim>(map, points, distance, all);
+	}
+} // namespace chs
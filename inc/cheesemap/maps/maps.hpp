@@ -1,5 +1,11 @@
 #pragma once
 
+#include "adaptive.hpp"
+#include "batch.hpp"
+#include "clusters.hpp"
 #include "Dense.hpp"
+#include "DenseCSR.hpp"
+#include "Factory.hpp"
 #include "Mixed.hpp"
+#include "outliers.hpp"
 #include "Sparse.hpp"
\ No newline at end of file
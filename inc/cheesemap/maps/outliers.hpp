@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <range/v3/all.hpp>
+
+#include "cheesemap/kernels/Sphere.hpp"
+#include "cheesemap/maps/batch.hpp"
+
+namespace chs
+{
+	/**
+	 * @brief Which points count as outliers, from the points within a radius of each of them. A point is an outlier
+	 * if it has fewer than min_neighbours others (radius outlier removal), or if its count is more than std_ratio
+	 * standard deviations below the mean count of the points tested (statistical outlier removal). Zero disables
+	 * either test.
+	 */
+	struct Outliers
+	{
+		double      radius{};
+		std::size_t min_neighbours{};
+		double      std_ratio{};
+	};
+
+	/**
+	 * @brief Number of other points of the map within radius of each point of the range, which need not be all the
+	 * points of the map: points of the map left out of the range still count, e.g. copies of the points of other
+	 * partitions around the border. Counted with the batched count of the map if it has one.
+	 */
+	template<std::size_t Dim = 3, typename Map_type, ranges::random_access_range Points_rng>
+	[[nodiscard]] inline auto neighbour_counts(const Map_type & map, const Points_rng & points, const double radius)
+	        -> std::vector<std::size_t>
+	{
+		const auto n     = static_cast<std::size_t>(ranges::distance(points));
+		const auto first = ranges::begin(points);
+
+		// Each point is inside its own sphere, then not counted
+		std::vector<std::size_t> counts(n);
+		const auto spheres = ranges::views::indices(n) | ranges::views::transform([&](const std::size_t i) {
+			                     return kernels::Sphere<Dim>(first[i], radius);
+		                     });
+		count_batch(map, spheres, [&](const std::size_t i, const std::size_t count) { counts[i] = count - 1; });
+		return counts;
+	}
+
+	/**
+	 * @brief Count below which a point is an outlier, the statistics of SOR taken over the given counts
+	 */
+	template<ranges::random_access_range Counts_rng>
+	[[nodiscard]] inline auto outlier_threshold(const Outliers & filter, const Counts_rng & counts) -> double
+	{
+		const auto n     = static_cast<std::size_t>(ranges::distance(counts));
+		const auto first = ranges::begin(counts);
+
+		double threshold = static_cast<double>(filter.min_neighbours);
+		if (filter.std_ratio > 0 and n > 0)
+		{
+			double sum = 0, sq_sum = 0;
+			#pragma omp parallel for reduction(+ : sum, sq_sum)
+			for (std::size_t i = 0; i < n; i++)
+			{
+				const auto count = static_cast<double>(first[i]);
+				sum += count;
+				sq_sum += count * count;
+			}
+			const double mean = sum / static_cast<double>(n);
+			const double sd   = std::sqrt(std::max(sq_sum / static_cast<double>(n) - mean * mean, 0.0));
+			threshold         = std::max(threshold, mean - filter.std_ratio * sd);
+		}
+		return threshold;
+	}
+
+	/**
+	 * @brief Tests the points of the range, counting their neighbours as neighbour_counts() does, the statistics of
+	 * SOR taken over all of them
+	 *
+	 * @return 1 for every point of the range found to be an outlier, 0 otherwise
+	 */
+	template<std::size_t Dim = 3, typename Map_type, ranges::random_access_range Points_rng>
+	[[nodiscard]] inline auto outliers(const Map_type & map, const Points_rng & points, const Outliers & filter)
+	        -> std::vector<std::uint8_t>
+	{
+		const auto counts    = neighbour_counts<Dim>(map, points, filter.radius);
+		const auto threshold = outlier_threshold(filter, counts);
+
+		std::vector<std::uint8_t> flags(counts.size());
+		#pragma omp parallel for
+		for (std::size_t i = 0; i < counts.size(); i++) { flags[i] = static_cast<double>(counts[i]) < threshold; }
+		return flags;
+	}
+} // namespace chs
@@ -102,5 +102,23 @@ namespace chs
 		}
 
 		[[nodiscard]] auto distance_to_wall(const Point & p) const { return distance_to_wall(p, is_inside(p)); }
+
+		/**
+		 * @brief Squared distances from p to the closest and to the farthest point of the box, over its first Dim axes
+		 */
+		template<std::size_t Sub_dim = Dim>
+		[[nodiscard]] auto sq_distance_range(const Point & p) const -> std::pair<double, double>
+		{
+			double near = 0;
+			double far  = 0;
+			for (std::size_t i = 0; i < Sub_dim; i++)
+			{
+				const auto gap  = std::max({ min_[i] - p[i], p[i] - max_[i], 0.0 });
+				const auto span = std::max(p[i] - min_[i], max_[i] - p[i]);
+				near += gap * gap;
+				far += span * span;
+			}
+			return { near, far };
+		}
 	};
 } // namespace chs
\ No newline at end of file
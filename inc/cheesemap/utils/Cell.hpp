@@ -9,6 +9,6 @@
 
 namespace chs
 {
-	template<typename Point_type>
-	using Cell = std::vector<Point_type *>;
+	template<typename Point_type, typename Allocator_type = std::allocator<Point_type *>>
+	using Cell = std::vector<Point_type *, Allocator_type>;
 } // namespace chs
\ No newline at end of file
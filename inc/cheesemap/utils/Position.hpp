@@ -0,0 +1,12 @@
+#pragma once
+
+namespace chs
+{
+	// Where a cell of a map lies with respect to a search kernel
+	enum class Position
+	{
+		OUTSIDE, // no point of the cell can be inside the kernel
+		INSIDE,  // every point of the cell is inside the kernel
+		PARTIAL, // its points have to be tested one by one
+	};
+} // namespace chs
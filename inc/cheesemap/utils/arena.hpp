@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace chs
+{
+	/**
+	 * @brief Memory resource serving allocations from a few large blocks with an atomic bump pointer, so maps can be
+	 * filled from several threads without going through malloc. Deallocation does nothing: memory is given back all
+	 * at once by reset(), once nothing allocated from the arena is alive anymore.
+	 *
+	 * Use it through std::pmr::polymorphic_allocator<Point_type *>, as the allocator of the maps that take one.
+	 */
+	class Arena : public std::pmr::memory_resource
+	{
+		static constexpr std::size_t DEFAULT_BLOCK_SIZE = std::size_t{ 1 } << 20;
+		static constexpr std::size_t ALIGNMENT          = alignof(std::max_align_t);
+
+		struct Block
+		{
+			std::unique_ptr<std::byte[]> data;
+			std::size_t                  size{};
+			std::atomic<std::size_t>     used{};
+
+			explicit Block(const std::size_t size) : data(new std::byte[size]), size(size) {}
+		};
+
+		std::vector<std::unique_ptr<Block>> blocks_;
+		std::atomic<Block *>                current_{};
+		std::size_t                         next_size_;
+		std::mutex                          mutex_;
+
+		void * do_allocate(std::size_t bytes, const std::size_t alignment) override
+		{
+			// Every size is a multiple of ALIGNMENT, so every offset is aligned to it
+			if (alignment > ALIGNMENT) { bytes += alignment; }
+			bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+			while (true)
+			{
+				Block * block = current_.load(std::memory_order_acquire);
+				const auto offset = block->used.fetch_add(bytes, std::memory_order_relaxed);
+				if (offset + bytes <= block->size)
+				{
+					void *      ptr   = block->data.get() + offset;
+					std::size_t space = bytes;
+					return std::align(alignment, bytes - (alignment > ALIGNMENT ? alignment : 0), ptr, space);
+				}
+
+				// Out of room, the first thread to get here adds a block and the rest retry on it
+				std::lock_guard lock(mutex_);
+				if (current_.load(std::memory_order_relaxed) == block)
+				{
+					next_size_ = std::max(2 * next_size_, bytes);
+					blocks_.emplace_back(std::make_unique<Block>(next_size_));
+					current_.store(blocks_.back().get(), std::memory_order_release);
+				}
+			}
+		}
+
+		void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+		{
+			return this == &other;
+		}
+
+		public:
+		explicit Arena(const std::size_t block_size = DEFAULT_BLOCK_SIZE) : next_size_(block_size)
+		{
+			blocks_.emplace_back(std::make_unique<Block>(block_size));
+			current_ = blocks_.back().get();
+		}
+
+		Arena(const Arena &)             = delete;
+		Arena & operator=(const Arena &) = delete;
+
+		/**
+		 * @brief Makes all the memory available again. If the last use needed more than one block, they are replaced
+		 * by a single one as big as all of them, so from then on a reset only rewinds the bump pointer.
+		 */
+		inline void reset()
+		{
+			if (blocks_.size() > 1)
+			{
+				std::size_t total = 0;
+				for (const auto & block : blocks_) { total += block->size; }
+				blocks_.clear();
+				blocks_.emplace_back(std::make_unique<Block>(total));
+				next_size_ = total;
+			}
+			blocks_.front()->used = 0;
+			current_              = blocks_.front().get();
+		}
+
+		[[nodiscard]] inline auto capacity() const -> std::size_t
+		{
+			std::size_t total = 0;
+			for (const auto & block : blocks_) { total += block->size; }
+			return total;
+		}
+	};
+} // namespace chs
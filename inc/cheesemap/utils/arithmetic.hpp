@@ -52,6 +52,14 @@ namespace chs
 		return std::sqrt(sq_distance(p1, p2, std::make_index_sequence<Dim>{}));
 	}
 
+	// a <= b, or a < b for the open kernels (Closed = false), which leave out the points on their boundary
+	template<bool Closed = true>
+	[[nodiscard]] inline constexpr auto within(const double a, const double b) -> bool
+	{
+		if constexpr (Closed) { return a <= b; }
+		else { return a < b; }
+	}
+
 	template<std::size_t... Is>
 	inline void clamp(auto & val, const auto & min, const auto & max, std::index_sequence<Is...>)
 	{
@@ -88,6 +96,32 @@ namespace chs
 		return min(a, std::make_index_sequence<Dim>{});
 	}
 
+	// Element-wise acc = min(acc, vals)
+	template<std::size_t... Is>
+	inline void min_into(auto & acc, const auto & vals, std::index_sequence<Is...>)
+	{
+		((std::get<Is>(acc) = std::min(std::get<Is>(acc), std::get<Is>(vals))), ...);
+	}
+
+	template<std::size_t Dim>
+	inline void min_into(auto & acc, const auto & vals)
+	{
+		min_into(acc, vals, std::make_index_sequence<Dim>{});
+	}
+
+	// Element-wise acc = max(acc, vals)
+	template<std::size_t... Is>
+	inline void max_into(auto & acc, const auto & vals, std::index_sequence<Is...>)
+	{
+		((std::get<Is>(acc) = std::max(std::get<Is>(acc), std::get<Is>(vals))), ...);
+	}
+
+	template<std::size_t Dim>
+	inline void max_into(auto & acc, const auto & vals)
+	{
+		max_into(acc, vals, std::make_index_sequence<Dim>{});
+	}
+
 	[[nodiscard]] inline auto radius_for_density(const auto & curr_pts, const auto & curr_r, const auto & trgt_pts)
 	{
 		const auto trgt_radius =
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "cheesemap/utils/parallel.hpp"
+
+namespace chs
+{
+	/**
+	 * @brief Items grouped by bucket: those of bucket b are order[offsets[b]] ... order[offsets[b + 1] - 1], in their
+	 * original relative order.
+	 */
+	template<typename Index_type = std::uint32_t>
+	struct Buckets
+	{
+		std::vector<Index_type> offsets;
+		std::vector<Index_type> order;
+	};
+
+	/**
+	 * @brief Stable counting sort of the items 0 ... n - 1 into num_buckets buckets, with the given threads.
+	 *
+	 * The items are split in one contiguous chunk per thread. Each thread counts its chunk, an exclusive scan of
+	 * the counts laid out bucket-major gives every (bucket, thread) pair its first slot, and each thread scatters its
+	 * chunk from there. Two linear passes over the items plus one over buckets x threads.
+	 */
+	template<typename Index_type = std::uint32_t, typename Key_fn>
+	[[nodiscard]] inline auto counting_sort(const std::size_t n, const std::size_t num_buckets, Key_fn && key,
+	                                        const std::size_t threads) -> Buckets<Index_type>
+	{
+		std::vector<std::size_t> keys(n);
+		std::vector<Index_type>  counts(num_buckets * threads, 0);
+
+		#pragma omp parallel for schedule(static) if (threads > 1)
+		for (std::size_t t = 0; t < threads; t++)
+		{
+			std::vector<Index_type> local(num_buckets, 0);
+			for (std::size_t i = n * t / threads; i < n * (t + 1) / threads; i++)
+			{
+				keys[i] = key(i);
+				local[keys[i]]++;
+			}
+			for (std::size_t b = 0; b < num_buckets; b++) { counts[b * threads + t] = local[b]; }
+		}
+
+		// Bounded by 4n by bucket(), so not worth splitting
+		std::exclusive_scan(counts.begin(), counts.end(), counts.begin(), Index_type{ 0 });
+
+		Buckets<Index_type> buckets;
+		buckets.order.resize(n);
+
+		#pragma omp parallel for schedule(static) if (threads > 1)
+		for (std::size_t t = 0; t < threads; t++)
+		{
+			std::vector<Index_type> cursor(num_buckets);
+			for (std::size_t b = 0; b < num_buckets; b++) { cursor[b] = counts[b * threads + t]; }
+			for (std::size_t i = n * t / threads; i < n * (t + 1) / threads; i++)
+			{
+				buckets.order[cursor[keys[i]]++] = static_cast<Index_type>(i);
+			}
+		}
+
+		buckets.offsets.resize(num_buckets + 1);
+		for (std::size_t b = 0; b < num_buckets; b++) { buckets.offsets[b] = counts[b * threads]; }
+		buckets.offsets[num_buckets] = static_cast<Index_type>(n);
+
+		return buckets;
+	}
+
+	/**
+	 * @brief Stable counting sort of the items 0 ... n - 1 into num_buckets buckets, in parallel if asked to.
+	 *
+	 * Per-thread counts only pay off while they stay small next to the input. With more buckets than that, the items
+	 * are first sorted into chunks of consecutive buckets, few enough for them, and then the threads sort the chunks,
+	 * each one on its own.
+	 *
+	 * @param key Bucket of an item, in [0, num_buckets).
+	 */
+	template<typename Index_type = std::uint32_t, typename Key_fn>
+	[[nodiscard]] inline auto bucket(const std::size_t n, const std::size_t num_buckets, Key_fn && key,
+	                                 const bool parallel = false) -> Buckets<Index_type>
+	{
+		const auto threads = parallel ? chs::num_threads() : std::size_t{ 1 };
+
+		if (threads > 1 and threads * num_buckets > 4 * n)
+		{
+			std::vector<std::size_t> keys(n);
+			#pragma omp parallel for schedule(static)
+			for (std::size_t i = 0; i < n; i++) { keys[i] = key(i); }
+
+			// Chunks of width consecutive buckets, about 4n / threads of them but at least one per thread, so that the
+			// cursors of all threads together span no more than the buckets
+			const auto wanted = std::max(4 * n / threads, threads);
+			const auto width  = (num_buckets + wanted - 1) / wanted;
+			const auto chunks = (num_buckets + width - 1) / width;
+			const auto coarse =
+			        counting_sort<Index_type>(n, chunks, [&](const std::size_t i) { return keys[i] / width; }, threads);
+
+			Buckets<Index_type> buckets;
+			buckets.order.resize(n);
+			buckets.offsets.resize(num_buckets + 1);
+
+			#pragma omp parallel
+			{
+				std::vector<Index_type> cursor(width);
+
+				#pragma omp for schedule(dynamic)
+				for (std::size_t c = 0; c < chunks; c++)
+				{
+					const auto first = c * width;
+					const auto last  = std::min(first + width, num_buckets);
+					std::fill(cursor.begin(), cursor.end(), Index_type{ 0 });
+					for (auto j = coarse.offsets[c]; j < coarse.offsets[c + 1]; j++)
+					{
+						cursor[keys[coarse.order[j]] - first]++;
+					}
+
+					// Buckets of the chunk start where the chunk does
+					auto offset = coarse.offsets[c];
+					for (auto b = first; b < last; b++)
+					{
+						buckets.offsets[b] = offset;
+						offset += std::exchange(cursor[b - first], offset);
+					}
+					for (auto j = coarse.offsets[c]; j < coarse.offsets[c + 1]; j++)
+					{
+						const auto i                             = coarse.order[j];
+						buckets.order[cursor[keys[i] - first]++] = i;
+					}
+				}
+			}
+			buckets.offsets[num_buckets] = static_cast<Index_type>(n);
+
+			return buckets;
+		}
+
+		return counting_sort<Index_type>(n, num_buckets, key, threads);
+	}
+
+	/**
+	 * @brief Items grouped by key, for keys too spread to histogram: the items of group g have key keys[g] and are
+	 * order[offsets[g]] ... order[offsets[g + 1] - 1], in their original relative order. Groups are sorted by key.
+	 */
+	template<typename Index_type = std::uint32_t>
+	struct Groups
+	{
+		std::vector<std::size_t> keys;
+		std::vector<Index_type>  offsets;
+		std::vector<Index_type>  order;
+	};
+
+	/**
+	 * @brief Stable grouping of the items 0 ... n - 1 by key, sorting (key, item) pairs. In parallel they are sorted
+	 * with an LSD radix sort on the OpenMP threads, one stable bucket() pass per byte the largest key uses.
+	 */
+	template<typename Index_type = std::uint32_t, typename Key_fn>
+	[[nodiscard]] inline auto group(const std::size_t n, Key_fn && key, const bool parallel = false)
+	        -> Groups<Index_type>
+	{
+		std::vector<std::pair<std::size_t, Index_type>> pairs(n);
+
+		#pragma omp parallel for if (parallel)
+		for (std::size_t i = 0; i < n; i++) { pairs[i] = { key(i), static_cast<Index_type>(i) }; }
+
+		if (parallel)
+		{
+			std::size_t max_key = 0;
+			#pragma omp parallel for reduction(max : max_key)
+			for (std::size_t i = 0; i < n; i++) { max_key = std::max(max_key, pairs[i].first); }
+
+			// Items start in their order, and every pass is stable, so equal keys keep it
+			std::vector<std::pair<std::size_t, Index_type>> sorted(n);
+			for (std::size_t shift = 0; shift < 8 * sizeof(std::size_t) and (max_key >> shift) != 0; shift += 8)
+			{
+				const auto buckets = bucket<Index_type>(
+				        n, 256, [&](const std::size_t i) { return (pairs[i].first >> shift) & 0xFF; }, true);
+				#pragma omp parallel for schedule(static)
+				for (std::size_t i = 0; i < n; i++) { sorted[i] = pairs[buckets.order[i]]; }
+				pairs.swap(sorted);
+			}
+		}
+		else { std::sort(pairs.begin(), pairs.end()); }
+
+		Groups<Index_type> groups;
+		groups.order.resize(n);
+		for (std::size_t i = 0; i < n; i++)
+		{
+			groups.order[i] = pairs[i].second;
+			if (i == 0 or pairs[i].first != pairs[i - 1].first)
+			{
+				groups.keys.emplace_back(pairs[i].first);
+				groups.offsets.emplace_back(static_cast<Index_type>(i));
+			}
+		}
+		groups.offsets.emplace_back(static_cast<Index_type>(n));
+
+		return groups;
+	}
+} // namespace chs
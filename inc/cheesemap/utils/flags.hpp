@@ -9,6 +9,8 @@ namespace chs::flags::build
 		PARALLEL      = 1 << 0,
 		REORDER       = 1 << 1,
 		SHRINK_TO_FIT = 1 << 2,
+		SORT_Z        = 1 << 3, // 2D maps keep the points of each cell sorted by z, to prune them by height
+		DYNAMIC       = 1 << 4, // keep the slot of every point in its cell, to remove points without searching
 	};
 
 	using flags_t = std::size_t;
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chs
+{
+	/**
+	 * @brief Open addressing hash map from cell indices to Value_type, for the cells of sparse maps. Entries live in a
+	 * single array of slots, so a lookup is a few contiguous reads instead of a walk over the nodes of a bucket.
+	 *
+	 * Robin Hood linear probing over a power of two number of slots with Fibonacci hashing: an entry never sits
+	 * further from its home slot than the one it passed, so a lookup stops as soon as it meets a closer one and
+	 * inserting shifts the rest of the run by one slot, as erasing shifts it back. The largest key is reserved to mark
+	 * empty slots. Slots are allocated with Allocator_type, which also reaches the values of the slots when it is a
+	 * polymorphic allocator.
+	 */
+	template<typename Value_type, typename Allocator_type = std::allocator<std::pair<std::size_t, Value_type>>>
+	class FlatMap
+	{
+		public:
+		using key_type       = std::size_t;
+		using mapped_type    = Value_type;
+		using value_type     = std::pair<key_type, Value_type>; // the key must not be changed through iterators
+		using allocator_type = Allocator_type;
+
+		private:
+		static constexpr key_type EMPTY = std::numeric_limits<key_type>::max();
+
+		// Most entries per slot before growing: 7/8
+		static constexpr std::size_t MAX_LOAD_NUM = 7;
+		static constexpr std::size_t MAX_LOAD_DEN = 8;
+
+		std::vector<value_type, Allocator_type> slots_;
+		std::size_t                             size_{};
+		std::size_t                             mask_{};
+		int                                     shift_{ std::numeric_limits<key_type>::digits };
+
+		[[nodiscard]] inline auto home(const key_type key) const -> std::size_t
+		{
+			return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+		}
+
+		// Slots between the home of the key in slot pos and pos
+		[[nodiscard]] inline auto distance(const key_type key, const std::size_t pos) const -> std::size_t
+		{
+			return (pos - home(key)) & mask_;
+		}
+
+		// Puts an entry known not to be in the map, with room for it
+		inline auto place(const key_type key) -> value_type &
+		{
+			auto        pos  = home(key);
+			std::size_t dist = 0;
+			while (slots_[pos].first != EMPTY and distance(slots_[pos].first, pos) >= dist)
+			{
+				pos = (pos + 1) & mask_;
+				dist++;
+			}
+
+			// Entries from pos to the end of the run move one slot forward
+			auto last = pos;
+			while (slots_[last].first != EMPTY) { last = (last + 1) & mask_; }
+			for (; last != pos; last = (last - 1) & mask_) { slots_[last] = std::move(slots_[(last - 1) & mask_]); }
+
+			slots_[pos].first = key;
+			size_++;
+			return slots_[pos];
+		}
+
+		inline void rehash(const std::size_t num_slots)
+		{
+			std::vector<value_type, Allocator_type> old(num_slots, slots_.get_allocator());
+			old.swap(slots_);
+
+			mask_  = num_slots - 1;
+			shift_ = std::numeric_limits<key_type>::digits - std::countr_zero(num_slots);
+			size_  = 0;
+			for (auto & slot : slots_) { slot.first = EMPTY; }
+
+			for (auto & slot : old)
+			{
+				if (slot.first != EMPTY) { place(slot.first).second = std::move(slot.second); }
+			}
+		}
+
+		// Slot of the key, or the number of slots if it is not in the map
+		[[nodiscard]] inline auto find_slot(const key_type key) const -> std::size_t
+		{
+			if (size_ == 0) { return slots_.size(); }
+
+			auto        pos  = home(key);
+			std::size_t dist = 0;
+			while (true)
+			{
+				const auto & slot = slots_[pos];
+				if (slot.first == key) { return pos; }
+				if (slot.first == EMPTY or distance(slot.first, pos) < dist) { return slots_.size(); }
+				pos = (pos + 1) & mask_;
+				dist++;
+			}
+		}
+
+		template<typename Self>
+		[[nodiscard]] static inline auto find_in(Self & self, const key_type key)
+		{
+			using It  = std::conditional_t<std::is_const_v<Self>, const_iterator, iterator>;
+			auto last = self.slots_.data() + self.slots_.size();
+			return It(self.slots_.data() + self.find_slot(key), last);
+		}
+
+		template<bool Const>
+		class Iterator
+		{
+			using slot_ptr = std::conditional_t<Const, const FlatMap::value_type *, FlatMap::value_type *>;
+
+			slot_ptr slot_{};
+			slot_ptr end_{};
+
+			inline void skip()
+			{
+				while (slot_ != end_ and slot_->first == EMPTY) { ++slot_; }
+			}
+
+			public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type        = FlatMap::value_type;
+			using difference_type   = std::ptrdiff_t;
+			using pointer           = slot_ptr;
+			using reference         = std::conditional_t<Const, const FlatMap::value_type &, FlatMap::value_type &>;
+
+			Iterator() = default;
+			Iterator(slot_ptr slot, slot_ptr end) : slot_(slot), end_(end) { skip(); }
+
+			operator Iterator<true>() const
+			        requires(not Const)
+			{
+				return { slot_, end_ };
+			}
+
+			[[nodiscard]] inline auto operator*() const -> reference { return *slot_; }
+			[[nodiscard]] inline auto operator->() const -> pointer { return slot_; }
+
+			inline auto operator++() -> Iterator &
+			{
+				++slot_;
+				skip();
+				return *this;
+			}
+
+			inline auto operator++(int) -> Iterator
+			{
+				auto old = *this;
+				++*this;
+				return old;
+			}
+
+			[[nodiscard]] friend inline bool operator==(const Iterator & a, const Iterator & b)
+			{
+				return a.slot_ == b.slot_;
+			}
+		};
+
+		public:
+		using iterator       = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		FlatMap() = default;
+		explicit FlatMap(const Allocator_type & alloc) : slots_(alloc) {}
+
+		[[nodiscard]] inline auto begin() { return iterator(slots_.data(), slots_.data() + slots_.size()); }
+		[[nodiscard]] inline auto end() { return iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size()); }
+		[[nodiscard]] inline auto begin() const
+		{
+			return const_iterator(slots_.data(), slots_.data() + slots_.size());
+		}
+		[[nodiscard]] inline auto end() const
+		{
+			return const_iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size());
+		}
+
+		[[nodiscard]] inline auto size() const { return size_; }
+		[[nodiscard]] inline auto empty() const { return size_ == 0; }
+		[[nodiscard]] inline auto bucket_count() const { return slots_.size(); }
+		[[nodiscard]] inline auto get_allocator() const { return slots_.get_allocator(); }
+
+		// Bytes taken by the slots, not counting what the values point to
+		[[nodiscard]] inline auto mem_footprint() const { return sizeof(*this) + slots_.capacity() * sizeof(value_type); }
+
+		/**
+		 * @brief Makes room for n entries, so that inserting up to them does not rehash
+		 */
+		inline void reserve(const std::size_t n)
+		{
+			if (n * MAX_LOAD_DEN <= slots_.size() * MAX_LOAD_NUM) { return; }
+			rehash(std::bit_ceil(std::max<std::size_t>(n * MAX_LOAD_DEN / MAX_LOAD_NUM + 1, 8)));
+		}
+
+		[[nodiscard]] inline auto find(const key_type key) { return find_in(*this, key); }
+		[[nodiscard]] inline auto find(const key_type key) const { return find_in(*this, key); }
+
+		/**
+		 * @brief Inserts the key with a value built from args, unless it is already in the map
+		 * @return The entry of the key and whether it was inserted
+		 */
+		template<typename... Args>
+		inline auto try_emplace(const key_type key, Args &&... args) -> std::pair<iterator, bool>
+		{
+			if (auto it = find(key); it != end()) { return { it, false }; }
+
+			reserve(size_ + 1);
+			auto & slot = place(key);
+			slot.second = Value_type(std::forward<Args>(args)...); // the slot may hold a moved-from value
+			return { iterator(&slot, slots_.data() + slots_.size()), true };
+		}
+
+		template<typename... Args>
+		inline auto emplace(const key_type key, Args &&... args) -> std::pair<iterator, bool>
+		{
+			return try_emplace(key, std::forward<Args>(args)...);
+		}
+
+		inline auto operator[](const key_type key) -> Value_type & { return try_emplace(key).first->second; }
+
+		/**
+		 * @brief Removes the key, moving back the entries after it in its run
+		 * @return Whether it was in the map
+		 */
+		inline auto erase(const key_type key) -> bool
+		{
+			auto pos = find_slot(key);
+			if (pos == slots_.size()) { return false; }
+
+			for (auto next = (pos + 1) & mask_;
+			     slots_[next].first != EMPTY and distance(slots_[next].first, next) > 0;
+			     pos = next, next = (next + 1) & mask_)
+			{
+				slots_[pos] = std::move(slots_[next]);
+			}
+
+			slots_[pos].first  = EMPTY;
+			slots_[pos].second = Value_type{};
+			size_--;
+			return true;
+		}
+
+		inline void clear()
+		{
+			for (auto & slot : slots_)
+			{
+				slot.first  = EMPTY;
+				slot.second = Value_type{};
+			}
+			size_ = 0;
+		}
+	};
+} // namespace chs
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace chs
+{
+	/**
+	 * @brief The k closest candidates seen so far, in a max-heap on the squared distance: the farthest one is always
+	 * on top, so each candidate costs O(log k) instead of shifting a sorted vector.
+	 */
+	template<typename T>
+	class knn_heap
+	{
+		using entry_type = std::pair<double, T>;
+
+		std::vector<entry_type> heap_;
+		std::size_t             k_;
+
+		static constexpr auto cmp = [](const entry_type & a, const entry_type & b) { return a.first < b.first; };
+
+		public:
+		explicit knn_heap(const std::size_t k) : k_(k) { heap_.reserve(k); }
+
+		[[nodiscard]] inline auto size() const { return heap_.size(); }
+		[[nodiscard]] inline auto empty() const { return heap_.empty(); }
+		[[nodiscard]] inline auto full() const { return heap_.size() >= k_; }
+		[[nodiscard]] inline auto capacity() const { return k_; }
+
+		// Squared distance of the farthest candidate kept, only when not empty
+		[[nodiscard]] inline auto worst() const { return heap_.front().first; }
+
+		/**
+		 * @brief Keeps the candidate if there is room or it is closer than the farthest one, which is dropped
+		 * @return Whether it was kept
+		 */
+		inline auto push(const double sq_distance, const T & value) -> bool
+		{
+			if (heap_.size() < k_)
+			{
+				heap_.emplace_back(sq_distance, value);
+				std::push_heap(heap_.begin(), heap_.end(), cmp);
+				return true;
+			}
+			if (k_ == 0 or not(sq_distance < heap_.front().first)) { return false; }
+
+			std::pop_heap(heap_.begin(), heap_.end(), cmp);
+			heap_.back() = { sq_distance, value };
+			std::push_heap(heap_.begin(), heap_.end(), cmp);
+			return true;
+		}
+
+		[[nodiscard]] inline auto count_within(const double sq_radius) const
+		{
+			return static_cast<std::size_t>(
+			        std::count_if(heap_.begin(), heap_.end(), [&](const auto & e) { return e.first <= sq_radius; }));
+		}
+
+		inline void clear() { heap_.clear(); }
+
+		/**
+		 * @brief Calls fn(sq_distance, value) for every candidate from the closest to the farthest and empties the heap
+		 */
+		inline void drain(auto && fn)
+		{
+			std::sort_heap(heap_.begin(), heap_.end(), cmp);
+			for (const auto & [sq_distance, value] : heap_) { fn(sq_distance, value); }
+			heap_.clear();
+		}
+	};
+
+	/**
+	 * @brief k nearest neighbours of every point in compressed sparse row layout: the neighbours of point i are
+	 * entries offsets[i] ... offsets[i + 1] - 1, from the closest to the farthest, as indices into the points the
+	 * graph was built for, with their distances
+	 */
+	struct KnnGraph
+	{
+		std::vector<std::size_t> offsets;
+		std::vector<std::size_t> neighbours;
+		std::vector<double>      distances;
+
+		[[nodiscard]] inline auto size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+		[[nodiscard]] inline auto neighbours_of(const std::size_t i) const
+		{
+			return std::span(neighbours).subspan(offsets[i], offsets[i + 1] - offsets[i]);
+		}
+
+		[[nodiscard]] inline auto distances_of(const std::size_t i) const
+		{
+			return std::span(distances).subspan(offsets[i], offsets[i + 1] - offsets[i]);
+		}
+
+		[[nodiscard]] inline auto mem_footprint() const
+		{
+			return sizeof(*this) + (offsets.capacity() + neighbours.capacity()) * sizeof(std::size_t) +
+			       distances.capacity() * sizeof(double);
+		}
+	};
+} // namespace chs
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chs
+{
+	/**
+	 * @brief Read-only memory mapping of a whole file, unmapped when the last owner lets it go. Pages are read on
+	 * first access, so a map loaded from a file only reads the cells it visits.
+	 */
+	class MappedFile
+	{
+		const std::byte * data_{};
+		std::size_t       size_{};
+
+		MappedFile(const std::byte * data, const std::size_t size) : data_(data), size_(size) {}
+
+		public:
+		MappedFile(const MappedFile &)             = delete;
+		MappedFile & operator=(const MappedFile &) = delete;
+
+		~MappedFile()
+		{
+			if (data_) { munmap(const_cast<std::byte *>(data_), size_); }
+		}
+
+		/**
+		 * @return The mapping of the file, or nullptr if it cannot be opened, is empty or cannot be mapped
+		 */
+		[[nodiscard]] static auto open(const std::filesystem::path & path) -> std::shared_ptr<const MappedFile>
+		{
+			const int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) { return nullptr; }
+
+			struct stat st{};
+			if (fstat(fd, &st) != 0 or st.st_size <= 0)
+			{
+				close(fd);
+				return nullptr;
+			}
+
+			const auto size = static_cast<std::size_t>(st.st_size);
+			void *     data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd); // the mapping keeps the file
+			if (data == MAP_FAILED) { return nullptr; }
+
+			return std::shared_ptr<const MappedFile>(new MappedFile(static_cast<const std::byte *>(data), size));
+		}
+
+		[[nodiscard]] inline auto data() const { return data_; }
+		[[nodiscard]] inline auto size() const { return size_; }
+	};
+} // namespace chs
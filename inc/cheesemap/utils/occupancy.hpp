@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "cheesemap/utils/Box.hpp"
+
+namespace chs
+{
+	/**
+	 * @brief Summary of how a set of points distributes over a regular grid.
+	 */
+	struct Occupancy
+	{
+		// Number of points analysed
+		std::size_t num_points{};
+
+		// Number of cells of the grid and how many of them hold no points
+		std::size_t num_cells{};
+		std::size_t empty_cells{};
+
+		// Largest number of points in a single cell
+		std::size_t max_occupancy{};
+
+		// histogram[0] counts empty cells, histogram[b] counts cells holding [2^(b-1), 2^b) points
+		std::vector<std::size_t> histogram;
+
+		// Mean points per cell as seen by a point of the cloud (sum(n_c^2) / sum(n_c))
+		double weighted_occupancy{};
+
+		// Number of cells the bounding box of a query of the given radius spans
+		double cells_per_query{};
+
+		// Fraction of the candidates of a column map that a 3D map would still test
+		double vertical_fraction{ 1.0 };
+
+		// Number of cells along z if the grid were 3D
+		std::size_t z_layers{ 1 };
+
+		[[nodiscard]] inline auto occupied_cells() const { return num_cells - empty_cells; }
+
+		[[nodiscard]] inline auto empty_ratio() const
+		{
+			if (num_cells == 0) { return 0.0; }
+			return static_cast<double>(empty_cells) / static_cast<double>(num_cells);
+		}
+
+		[[nodiscard]] inline auto mean_occupancy() const
+		{
+			if (occupied_cells() == 0) { return 0.0; }
+			return static_cast<double>(num_points) / static_cast<double>(occupied_cells());
+		}
+
+		[[nodiscard]] inline auto candidates_per_query() const { return cells_per_query * weighted_occupancy; }
+	};
+
+	/**
+	 * @brief Counts the points falling in each cell of a Dim-dimensional grid of per-axis resolutions res laid
+	 * over box, using the same cell assignment as the maps.
+	 *
+	 * @param radius Radius of the queries that will be issued against the map.
+	 */
+	template<std::size_t Dim = 2, typename Points_rng>
+	[[nodiscard]] inline auto occupancy(const Points_rng & points, const Box & box, const std::array<double, 3> & res,
+	                                    const double radius) -> Occupancy
+	{
+		static_assert(Dim == 2 or Dim == 3, "chs::occupancy<> dimension must be 2 or 3");
+
+		Occupancy occ;
+
+		std::array<std::size_t, Dim> sizes{};
+		occ.num_cells = 1;
+		for (std::size_t i = 0; i < Dim; i++)
+		{
+			sizes[i] = static_cast<std::size_t>(std::floor((box.max()[i] - box.min()[i]) / res[i])) + 1;
+			occ.num_cells *= sizes[i];
+		}
+		occ.z_layers = static_cast<std::size_t>(std::floor((box.max()[2] - box.min()[2]) / res[2])) + 1;
+
+		std::vector<std::uint32_t> counts(occ.num_cells, 0);
+
+		// Vertical extent of each column, only meaningful for 2D grids
+		std::vector<std::pair<double, double>> z_ranges;
+		if constexpr (Dim == 2)
+		{
+			z_ranges.assign(occ.num_cells,
+			                { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() });
+		}
+
+		for (const auto & p : points)
+		{
+			std::size_t idx = 0;
+			for (std::size_t i = 0; i < Dim; i++)
+			{
+				const auto diff = std::clamp(p[i] - box.min()[i], 0.0, box.max()[i] - box.min()[i]);
+				idx             = idx * sizes[i] + static_cast<std::size_t>(diff / res[i]);
+			}
+
+			counts[idx]++;
+			occ.num_points++;
+
+			if constexpr (Dim == 2)
+			{
+				z_ranges[idx].first  = std::min(z_ranges[idx].first, static_cast<double>(p[2]));
+				z_ranges[idx].second = std::max(z_ranges[idx].second, static_cast<double>(p[2]));
+			}
+		}
+
+		// A query of the given radius slices a column of points down to 2r + res in height
+		const auto slab = 2 * radius + res[2];
+
+		double sq_sum       = 0;
+		double vertical_sum = 0;
+		for (std::size_t c = 0; c < counts.size(); c++)
+		{
+			const auto n   = counts[c];
+			const auto bin = static_cast<std::size_t>(std::bit_width(n));
+			if (occ.histogram.size() <= bin) { occ.histogram.resize(bin + 1, 0); }
+			occ.histogram[bin]++;
+
+			if (n == 0)
+			{
+				occ.empty_cells++;
+				continue;
+			}
+
+			occ.max_occupancy = std::max<std::size_t>(occ.max_occupancy, n);
+
+			const auto sq_n = static_cast<double>(n) * static_cast<double>(n);
+			sq_sum += sq_n;
+
+			if constexpr (Dim == 2)
+			{
+				const auto span = z_ranges[c].second - z_ranges[c].first;
+				vertical_sum += sq_n * (span > slab ? slab / span : 1.0);
+			}
+		}
+
+		if (occ.num_points > 0)
+		{
+			occ.weighted_occupancy = sq_sum / static_cast<double>(occ.num_points);
+			if constexpr (Dim == 2) { occ.vertical_fraction = vertical_sum / sq_sum; }
+		}
+
+		occ.cells_per_query = 1;
+		for (std::size_t i = 0; i < Dim; i++) { occ.cells_per_query *= 2 * radius / res[i] + 1; }
+
+		return occ;
+	}
+
+	template<std::size_t Dim = 2, typename Points_rng>
+	[[nodiscard]] inline auto occupancy(const Points_rng & points, const Box & box, const double res,
+	                                    const double radius) -> Occupancy
+	{
+		return occupancy<Dim>(points, box, std::array<double, 3>{ res, res, res }, radius);
+	}
+} // namespace chs
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace chs
+{
+	/**
+	 * @brief Coordinates of a run of points as one array per axis, so that kernels can test several points at once
+	 * with SIMD instructions instead of one point at a time
+	 */
+	struct PackedPoints
+	{
+		std::array<const double *, 3> axes{};
+		std::size_t                   size{};
+	};
+} // namespace chs
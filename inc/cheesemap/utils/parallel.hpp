@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace chs
+{
+	// Threads a parallel region would use, 1 when built without OpenMP
+	[[nodiscard]] inline auto num_threads() -> std::size_t
+	{
+#ifdef _OPENMP
+		return static_cast<std::size_t>(omp_get_max_threads());
+#else
+		return 1;
+#endif
+	}
+} // namespace chs
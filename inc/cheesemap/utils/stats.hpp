@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+namespace chs
+{
+	/**
+	 * @brief Work done by a batch of queries. Cells and candidates are only counted by maps with a batched query,
+	 * the rest report queries and neighbours found.
+	 */
+	struct QueryStats
+	{
+		std::size_t queries{};
+		std::size_t cells{};      // cells visited
+		std::size_t candidates{}; // points tested against a kernel
+		std::size_t found{};      // points inside the kernels
+
+		inline auto operator+=(const QueryStats & other) -> QueryStats &
+		{
+			queries += other.queries;
+			cells += other.cells;
+			candidates += other.candidates;
+			found += other.found;
+			return *this;
+		}
+	};
+} // namespace chs
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+
+#include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/flat_map.hpp"
+
+namespace chs::tuning
+{
+	// Cost of visiting a cell (index arithmetic, box test against the kernel, cell lookup) in point tests
+	inline constexpr double CELL_COST = 4.0;
+
+	// Finer grids than this spend more building and holding empty cells than they save testing points
+	inline constexpr double MAX_CELLS_PER_POINT = 4.0;
+
+	// Most points local_density() looks at, evenly strided over the cloud
+	inline constexpr std::size_t DENSITY_SAMPLE = std::size_t{ 1 } << 20;
+
+	/**
+	 * @brief Points per unit of area (Dim 2) or volume (Dim 3) as seen from a point of the cloud. The grid is probed
+	 * at the scale of the queries, so the empty space around the cloud and its holes do not dilute the estimate.
+	 *
+	 * Only the occupied cells of a sample of the points are counted, in a hash map, so memory is bounded by the
+	 * sample whatever the extent of the box. Counts are scaled back to the whole cloud, correcting the bias of
+	 * squaring sampled counts.
+	 */
+	template<std::size_t Dim = 2, typename Points_rng>
+	[[nodiscard]] inline auto local_density(const Points_rng & points, const Box & box, const double radius) -> double
+	{
+		const auto n = static_cast<std::size_t>(std::ranges::distance(points));
+		if (n == 0 or radius <= 0) { return 0; }
+		const auto stride = (n + DENSITY_SAMPLE - 1) / DENSITY_SAMPLE;
+
+		std::array<std::size_t, Dim> sizes{};
+		for (std::size_t i = 0; i < Dim; i++)
+		{
+			sizes[i] = static_cast<std::size_t>(std::floor((box.max()[i] - box.min()[i]) / radius)) + 1;
+		}
+
+		FlatMap<std::uint32_t> counts;
+		counts.reserve(std::min(n, DENSITY_SAMPLE));
+		std::size_t i = 0, sampled = 0;
+		for (const auto & p : points)
+		{
+			if (i++ % stride != 0) { continue; }
+
+			std::size_t key = 0;
+			for (std::size_t d = 0; d < Dim; d++)
+			{
+				const auto diff = std::clamp(p[d] - box.min()[d], 0.0, box.max()[d] - box.min()[d]);
+				key             = key * sizes[d] + static_cast<std::size_t>(diff / radius);
+			}
+			counts[key]++;
+			sampled++;
+		}
+
+		// E[c^2] = f^2 n^2 + f (1 - f) n for a cell of n points sampled with probability f
+		const auto f      = static_cast<double>(sampled) / static_cast<double>(n);
+		double     sq_sum = 0;
+		for (const auto & [key, c] : counts) { sq_sum += static_cast<double>(c) * static_cast<double>(c); }
+		const auto weighted = (sq_sum - (1 - f) * static_cast<double>(sampled)) / (f * static_cast<double>(sampled));
+
+		return std::max(weighted, 1.0) / std::pow(radius, static_cast<double>(Dim));
+	}
+
+	/**
+	 * @brief Expected cost of a query of the given radius over a grid of cell size res, as cells visited plus
+	 * candidates tested.
+	 */
+	template<std::size_t Dim = 2>
+	[[nodiscard]] inline auto query_cost(const double res, const double radius, const double density) -> double
+	{
+		const auto d = static_cast<double>(Dim);
+		return CELL_COST * std::pow(2 * radius / res + 1, d) + density * std::pow(2 * radius + res, d);
+	}
+
+	/**
+	 * @brief Cell size minimising query_cost(), i.e. the root of its derivative: density * res^(Dim+1) = 2r * CELL_COST.
+	 */
+	template<std::size_t Dim = 2>
+	[[nodiscard]] inline auto optimal_resolution(const double radius, const double density) -> double
+	{
+		if (density <= 0) { return 2 * radius; }
+		return std::pow(2 * radius * CELL_COST / density, 1.0 / static_cast<double>(Dim + 1));
+	}
+
+	template<std::size_t Dim = 2>
+	[[nodiscard]] inline auto num_cells(const Box & box, const std::array<double, 3> & res) -> double
+	{
+		double cells = 1;
+		for (std::size_t i = 0; i < Dim; i++) { cells *= std::floor((box.max()[i] - box.min()[i]) / res[i]) + 1; }
+		return cells;
+	}
+
+	template<std::size_t Dim = 2>
+	[[nodiscard]] inline auto within_budget(const Box & box, const std::array<double, 3> & res,
+	                                        const std::size_t num_points) -> bool
+	{
+		return num_cells<Dim>(box, res) <= MAX_CELLS_PER_POINT * static_cast<double>(std::max<std::size_t>(num_points, 1));
+	}
+
+	/**
+	 * @brief Per-axis cell sizes for a map of the points queried with the given radius. x and y follow the column
+	 * (2D) cost model; z follows the 3D one, as it only matters to maps that slice the columns.
+	 */
+	template<typename Points_rng>
+	[[nodiscard]] inline auto resolutions(const Points_rng & points, const double radius) -> std::array<double, 3>
+	{
+		const auto box = Box::mbb(points);
+		const auto n   = static_cast<std::size_t>(std::ranges::distance(points));
+
+		const auto xy = optimal_resolution<2>(radius, local_density<2>(points, box, radius));
+		const auto z  = optimal_resolution<3>(radius, local_density<3>(points, box, radius));
+
+		std::array<double, 3> res{ xy, xy, z };
+		while (not within_budget<2>(box, res, n)) { res[0] = res[1] = res[0] * 1.25; }
+		while (not within_budget<3>(box, res, n)) { res[2] *= 1.25; }
+
+		return res;
+	}
+} // namespace chs::tuning
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+#include "cheesemap/utils/Box.hpp"
+#include "cheesemap/utils/flat_map.hpp"
+#include "cheesemap/utils/zsort.hpp"
+
+namespace chs
+{
+	/**
+	 * @brief Position of every point within its cell (maps built with DYNAMIC), so that removing a point does not
+	 * search its cell for it
+	 */
+	template<typename Point_type>
+	class PointSlots
+	{
+		FlatMap<std::size_t> slots_;
+
+		[[nodiscard]] static inline auto key(const Point_type * point)
+		{
+			return static_cast<std::size_t>(reinterpret_cast<std::uintptr_t>(point));
+		}
+
+		public:
+		inline void reserve(const std::size_t n) { slots_.reserve(n); }
+
+		inline void set(const Point_type * point, const std::size_t slot) { slots_[key(point)] = slot; }
+
+		// Slot of the point, or the size of the cell if it is not indexed
+		[[nodiscard]] inline auto find(const Point_type * point, const std::size_t cell_size) const
+		{
+			const auto it = slots_.find(key(point));
+			return it == slots_.end() ? cell_size : it->second;
+		}
+
+		inline void erase(const Point_type * point) { slots_.erase(key(point)); }
+
+		[[nodiscard]] inline auto size() const { return slots_.size(); }
+
+		[[nodiscard]] inline auto mem_footprint() const { return slots_.mem_footprint(); }
+	};
+
+	/**
+	 * @brief Adds the point to the cell, after the points not above it if the cell is sorted by z, and records the
+	 * slots that change
+	 */
+	template<typename Cell_type, typename Point_type>
+	inline void cell_insert(Cell_type & cell, Point_type * point, const bool sorted_z, PointSlots<Point_type> * slots)
+	{
+		if (not sorted_z)
+		{
+			cell.emplace_back(point);
+			if (slots) { slots->set(point, cell.size() - 1); }
+			return;
+		}
+
+		const auto it  = chs::z_range(cell.begin(), cell.end(), (*point)[2], (*point)[2]).second;
+		const auto pos = static_cast<std::size_t>(std::distance(cell.begin(), it));
+		cell.insert(it, point);
+		if (slots)
+		{
+			for (auto s = pos; s < cell.size(); s++) { slots->set(cell[s], s); }
+		}
+	}
+
+	/**
+	 * @brief Takes the point out of the cell. The last point of the cell fills its slot, unless the cell is sorted by z
+	 * and the points after it move back instead.
+	 * @return Whether the point was in the cell
+	 */
+	template<typename Cell_type, typename Point_type>
+	inline auto cell_remove(Cell_type & cell, const Point_type * point, const bool sorted_z,
+	                        PointSlots<Point_type> * slots) -> bool
+	{
+		auto pos = slots ? slots->find(point, cell.size()) : cell.size();
+		if (pos >= cell.size() or cell[pos] != point)
+		{
+			pos = static_cast<std::size_t>(std::distance(cell.begin(), std::find(cell.begin(), cell.end(), point)));
+			if (pos == cell.size()) { return false; }
+		}
+		if (slots) { slots->erase(point); }
+
+		if (sorted_z)
+		{
+			cell.erase(cell.begin() + static_cast<std::ptrdiff_t>(pos));
+			if (slots)
+			{
+				for (auto s = pos; s < cell.size(); s++) { slots->set(cell[s], s); }
+			}
+			return true;
+		}
+
+		cell[pos] = cell.back();
+		cell.pop_back();
+		if (slots and pos < cell.size()) { slots->set(cell[pos], pos); }
+		return true;
+	}
+
+	/**
+	 * @brief Grows the bounding box and sizes of a grid so that it holds box. Cells are added in whole cells before and
+	 * after each dimension, so the ones it had keep their bounds, and a side that grows gets at least half of the
+	 * cells it had, so that a stream of points moving in one direction only extends the grid a logarithmic number of
+	 * times.
+	 * @return Whether the grid grew, and the points in it must then be placed again
+	 */
+	template<std::size_t Dim>
+	inline auto extend_grid(Box & grid_box, auto & sizes, const auto & resolutions, const Box & box) -> bool
+	{
+		Point min  = grid_box.min();
+		Point max  = grid_box.max();
+		bool  grew = false;
+
+		const auto grow = [&](const double gap, const double res, const std::size_t size) -> std::size_t {
+			if (not(gap > 0)) { return 0; }
+			grew = true;
+			return std::max(static_cast<std::size_t>(std::ceil(gap / res)), std::max<std::size_t>(size / 2, 1));
+		};
+
+		[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+			std::size_t before;
+			std::size_t after;
+			(((before = grow(min[Is] - box.min()[Is], std::get<Is>(resolutions), std::get<Is>(sizes))),
+			  (after = grow(box.max()[Is] - max[Is], std::get<Is>(resolutions), std::get<Is>(sizes))),
+			  (min[Is] -= static_cast<double>(before) * std::get<Is>(resolutions)),
+			  (max[Is] += static_cast<double>(after) * std::get<Is>(resolutions)),
+			  (std::get<Is>(sizes) += before + after)),
+			 ...);
+		}(std::make_index_sequence<Dim>{});
+
+		if (grew) { grid_box = Box(std::make_pair(min, max)); }
+		return grew;
+	}
+} // namespace chs
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include "cheesemap/concepts/Kernel.hpp"
+
+namespace chs
+{
+	// Height of a point, or of the point pointed to
+	template<typename T>
+	[[nodiscard]] inline auto z_of(const T & p) -> double
+	{
+		if constexpr (std::is_pointer_v<T>) { return (*p)[2]; }
+		else { return p[2]; }
+	}
+
+	/**
+	 * @brief Sorts the points of a cell by height, so that the ones within a height interval can be found with
+	 * z_range instead of testing the whole cell
+	 */
+	template<typename It>
+	inline void sort_z(It first, It last)
+	{
+		std::sort(first, last, [](const auto & a, const auto & b) { return z_of(a) < z_of(b); });
+	}
+
+	/**
+	 * @brief Points of a cell sorted with sort_z whose height is within [min, max]
+	 */
+	template<typename It>
+	[[nodiscard]] inline auto z_range(It first, It last, const double min, const double max) -> std::pair<It, It>
+	{
+		const auto lo = std::lower_bound(first, last, min, [](const auto & p, const double z) { return z_of(p) < z; });
+		const auto hi = std::upper_bound(lo, last, max, [](const double z, const auto & p) { return z < z_of(p); });
+		return { lo, hi };
+	}
+
+	/**
+	 * @brief Whether the points inside kernels of this type are within the height of their box, so that z_range can
+	 * prune the columns they visit. Otherwise the whole column must be tested.
+	 */
+	template<typename Kernel_t>
+	inline constexpr bool bounds_z = concepts::HeightBoundedKernel<std::remove_cvref_t<Kernel_t>>;
+} // namespace chs
@@ -0,0 +1,39 @@
+//
+// Euclidean clusters across boxes and ranks: every box labels its own clusters, then the labels of the points that
+// several boxes hold are merged
+//
+
+#pragma once
+
+#include "Box.hpp"
+#include "Lpoint.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// A point near the border of a box, with the label it got there
+struct ClusterRecord
+{
+	double   x, y, z;
+	uint64_t label;
+};
+
+/**
+ * @brief Appends the points of a box at most distance inside or outside of its border, with their cluster. Whatever
+ * joins two clusters of different boxes is one of these points, held by both boxes: the overlap copy in one and the
+ * point itself in the other.
+ */
+void boundaryRecords(const std::vector<Lpoint>& points, const Box& box, double distance,
+                     std::vector<ClusterRecord>& records);
+
+/**
+ * @brief Gathers the records of all ranks, joins the labels of the records at the same coordinates and sends back
+ * the result. Collective over MPI_COMM_WORLD.
+ *
+ * Rank 0 holds, sorts and joins the records of every rank alone, while the others wait for the result. That serial
+ * step grows with the total number of boundary points, not with the cloud, but it is what limits scaling to many
+ * ranks with small boxes.
+ * @return Label to which every joined label must be changed, the smallest of its cluster. Labels not in it stay.
+ */
+std::unordered_map<uint64_t, uint64_t> mergeClusters(const std::vector<ClusterRecord>& records);
@@ -46,6 +46,12 @@ std::pair<Point, Point> readBoundingBox(const fs::path& filename);
 
 void writePointCloud(const fs::path& fileName, std::vector<Lpoint>& points);
 
-void writePointCloudDescriptors(const fs::path& fileName, std::vector<Lpoint>& points);
+/**
+ * @brief Writes the points and their descriptors in the format of the file extension. A .npy path becomes a directory
+ * named as it without the extension, with a .npy file per column; cluster.npy and filtered.npy are among them when
+ * clustering or filtering outliers, whatever the labels are.
+ */
+void writePointCloudDescriptors(const fs::path& fileName, std::vector<Lpoint>& points, bool clusters = false,
+                                bool filtered = false);
 
 #endif //CPP_HANDLERS_H
@@ -0,0 +1,24 @@
+//
+// On-disk cache of the cheesemap of every box, keyed by what the map depends on
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Identifies the map of a box: the input file (path, size and modification time), the partitioning
+ * (processes, rank, box and how far the box reads beyond itself), the points read for the box and how the map is
+ * built on them. A cached map is only loaded if its fingerprint matches.
+ */
+uint64_t indexFingerprint(const fs::path& input, int npes, int rank, unsigned box, float overlap, size_t npoints,
+                          const std::array<double, 3>& res, size_t flags);
+
+// File holding the map of a box of this rank
+fs::path indexCachePath(const fs::path& dir, const std::string& fileName, int rank, unsigned box);
@@ -0,0 +1,73 @@
+//
+// Timing regions and counters, aggregated per thread and rank
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+enum Counter
+{
+	POINTS_READ = 0,   // points read by the rank, overlap included
+	QUERIES,           // neighbourhood searches
+	CELLS_VISITED,     // map cells visited by the searches
+	CANDIDATES_TESTED, // points tested against a search kernel
+	NEIGHBORS_FOUND,   // points inside a search kernel
+	POINTS_FILTERED,   // outliers left out of the descriptors
+	COUNTER_COUNT
+};
+
+/**
+ * @brief Scoped timing region. Regions opened while another one is open in the same thread nest inside it, and
+ * are aggregated by their path ("box/descriptors"), each one also kept as an event for the trace.
+ *
+ * Regions built with trace = false are meant for the body of parallel loops, entered too often to be traced one by
+ * one and from threads that nest differently: they are only aggregated, by their name alone.
+ */
+class Region
+{
+	using clock = std::chrono::steady_clock;
+
+	const char*       name_;
+	clock::time_point start_;
+	bool              trace_;
+	bool              open_{ true };
+
+	public:
+	explicit Region(const char* name, bool trace = true);
+	~Region() { stop(); }
+
+	Region(const Region&)            = delete;
+	Region& operator=(const Region&) = delete;
+
+	/**
+	 * @brief Closes the region before the end of its scope
+	 * @return Seconds spent in the region
+	 */
+	double stop();
+};
+
+/**
+ * @brief Adds n to a counter, from any thread
+ */
+void count(Counter counter, uint64_t n);
+
+/**
+ * @brief Turns on the collection of events for the trace. Regions are always timed, so that stop() returns the
+ * seconds spent in them, but only aggregated unless this is on.
+ */
+void enableTracing();
+
+/**
+ * @brief Collective over MPI_COMM_WORLD. Rank 0 writes to dir:
+ *  - name_profile.json: per region path, calls and seconds with their spread across threads and ranks, and every
+ *    counter summed over ranks with its per-rank maximum.
+ *  - name_trace.json (only when tracing): the events of every thread of every rank in Chrome trace format, to be
+ *    opened with chrome://tracing or Perfetto.
+ */
+void writeProfile(const fs::path& dir, const std::string& name);
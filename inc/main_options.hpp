@@ -22,6 +22,7 @@
 #include <filesystem>
 #include <getopt.h>
 #include <iostream>
+#include <string>
 
 namespace fs = std::filesystem;
 
@@ -33,8 +34,22 @@ class main_options
 	fs::path      outputDirName{};
 	int			  dec{0};
 	float	  	  cellSize{1.0};
+	bool		  autoCellSize{false};	// pick the cheesemap cell size from radius and density (-s auto)
+	bool		  tuneBench{false};		// refine the automatic cell size with a micro-benchmark
+	bool		  exportCol{false};		// convert the input to the columnar format and read that instead
 	float		  radius{0};
+	size_t		  neighbors{0};		// target neighbors of the adaptive radius, -r is then the maximum radius
 	bool		  zip{false};
+	bool		  npy{false};		// also write the descriptors as NumPy arrays
+	bool		  trace{false};		// write a Chrome trace of the timed regions
+	bool		  perf{false};		// hardware counters per phase in the debug CSV
+	std::string	  bind{};			// thread pinning (close, spread), none if empty
+	std::string	  mapType{"auto"};	// cheesemap type (auto, dense, csr, sparse, mixed3d)
+	fs::path	  indexCache{};		// directory to save the CSR maps to and load them from, no cache if empty
+	float		  clusterDist{0};	// distance joining points into Euclidean clusters, no clustering if 0
+	float		  sorRatio{0};		// standard deviations below the mean neighbor count marking outliers, off if 0
+	size_t		  rorNeighbors{0};	// fewest neighbors of a point not marked as outlier, off if 0
+	float		  outlierRadius{0};	// radius the neighbors of the outlier filters are counted in, -r if 0
 };
 
 extern main_options mainOptions;
@@ -42,6 +57,19 @@ extern main_options mainOptions;
 enum LongOptions : int
 {
 	HELP = 0, // Help message
+	MAP,      // Cheesemap type
+	TUNE,     // Benchmark the automatic cell size
+	COL,      // Convert the input to the columnar format
+	NPY,      // Also write descriptors as NumPy arrays
+	NEIGH,    // Adaptive radius targeting a number of neighbors
+	BIND,     // Thread pinning
+	TRACE,    // Chrome trace of the timed regions
+	PERF,     // Hardware counters per phase
+	CACHE,    // Directory of the saved maps
+	CLUSTER,  // Euclidean clustering distance
+	SOR,      // Statistical outlier removal
+	ROR,      // Radius outlier removal
+	OUTRAD,   // Radius of the outlier filters
 };
 
 // Define short options
@@ -50,6 +78,20 @@ const char* const short_opts = "h:i:o:R:s:r:z";
 // Define long options
 const option long_opts[] = {
 	{ "help", no_argument, nullptr, LongOptions::HELP },
+	{ "map", required_argument, nullptr, LongOptions::MAP },
+	{ "tune-bench", no_argument, nullptr, LongOptions::TUNE },
+	{ "col", no_argument, nullptr, LongOptions::COL },
+	{ "npy", no_argument, nullptr, LongOptions::NPY },
+	{ "neighbors", required_argument, nullptr, LongOptions::NEIGH },
+	{ "bind", required_argument, nullptr, LongOptions::BIND },
+	{ "trace", no_argument, nullptr, LongOptions::TRACE },
+	{ "perf", no_argument, nullptr, LongOptions::PERF },
+	{ "index-cache", required_argument, nullptr, LongOptions::CACHE },
+	{ "cluster", required_argument, nullptr, LongOptions::CLUSTER },
+	{ "sor", required_argument, nullptr, LongOptions::SOR },
+	{ "ror", required_argument, nullptr, LongOptions::ROR },
+	{ "outlier-radius", required_argument, nullptr, LongOptions::OUTRAD },
+	{ nullptr, 0, nullptr, 0 },
 };
 
 void printHelp();
@@ -0,0 +1,31 @@
+//
+// NUMA placement of threads and point data
+//
+
+#pragma once
+
+#include "Lpoint.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Number of NUMA nodes of this machine, 1 if it cannot be told
+ */
+int numaNodes();
+
+/**
+ * @brief Pins every OpenMP thread to one CPU. "close" packs them on consecutive CPUs, "spread" scatters them over
+ * all of them, so they end up in every socket. When the launcher did not bind the rank already, the CPUs of the
+ * machine are split between the nodeSize ranks sharing it. OpenMP keeps its threads between parallel regions of the
+ * same size, so they stay pinned.
+ */
+void bindThreads(const std::string& policy, int nodeRank, int nodeSize);
+
+/**
+ * @brief Moves the pages of the points round-robin over the NUMA nodes the threads of this rank may run on, in place,
+ * so call it after bindThreads(). Readers fill the points from the main thread, leaving them all on its socket, while
+ * queries from threads of every socket reach any of them, so spreading them evenly shares the load on the memory
+ * controllers. A rank kept within one node, e.g. one rank per socket, leaves its points where they are.
+ * @return Whether they were moved, false if the threads of the rank run on a single node or if the kernel refused
+ */
+bool interleave(std::vector<Lpoint>& points);
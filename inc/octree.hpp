@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -32,6 +33,111 @@ class Octree
 	std::vector<Lpoint*> points_{};
 	float                radius_{};
 
+	// Coordinates of the points of a leaf, one array per axis, for the kernels to test them several at a time
+	std::array<std::vector<double>, 3> coords_{};
+
+	void addPoint(Lpoint* p);
+	void erasePoint(size_t i);
+	void clearPoints();
+
+	[[nodiscard]] inline chs::PackedPoints packed(const size_t first, const size_t n) const
+	{
+		return { { coords_[0].data() + first, coords_[1].data() + first, coords_[2].data() + first }, n };
+	}
+
+	template<typename Kernel_type>
+	[[nodiscard]] inline chs::Position classify(const Kernel_type& k) const
+	/**
+	 * @brief Whether the cube of the octant lies outside, inside or across the kernel. Kernels that cannot tell are
+	 * only checked for overlap with their bounding box.
+	 */
+	{
+		const chs::Box box(center_, static_cast<double>(radius_));
+		if constexpr (chs::concepts::ClassifyingKernel<Kernel_type, chs::Point>) { return k.classify(box); }
+		else
+		{
+			for (size_t i = 0; i < 3; i++)
+			{
+				if (box.max()[i] < k.box().min()[i] || k.box().max()[i] < box.min()[i])
+				{
+					return chs::Position::OUTSIDE;
+				}
+			}
+			return chs::Position::PARTIAL;
+		}
+	}
+
+	template<typename Function>
+	void forEachPoint(Function&& fn) const
+	{
+		if (isLeaf())
+		{
+			for (Lpoint* point_ptr : points_) { fn(point_ptr); }
+			return;
+		}
+		for (const auto& octant : octants_) { octant.forEachPoint(fn); }
+	}
+
+	template<typename Kernel_type, typename Function>
+	void forEachInsideLeaf(const Kernel_type& k, Function&& fn) const
+	{
+		if constexpr (chs::concepts::PackedKernel<Kernel_type, chs::Point>)
+		{
+			constexpr size_t RUN = 64; // points tested at once, so that the results stay on the stack
+			std::array<std::uint8_t, RUN> inside;
+			for (size_t first = 0; first < points_.size(); first += RUN)
+			{
+				const size_t n = std::min(RUN, points_.size() - first);
+				k.is_inside(packed(first, n), inside.data());
+				for (size_t i = 0; i < n; i++)
+				{
+					if (inside[i]) { fn(points_[first + i]); }
+				}
+			}
+		}
+		else
+		{
+			for (Lpoint* point_ptr : points_)
+			{
+				if (k.is_inside(*point_ptr)) { fn(point_ptr); }
+			}
+		}
+	}
+
+	template<typename Kernel_type, typename Function>
+	void forEachInside(const Kernel_type& k, Function&& fn) const
+	/**
+	 * @brief Calls fn(point) for every point inside the kernel. Octants the kernel covers whole are taken without
+	 * testing their points, and the points of the leaves it crosses are tested in packed runs.
+	 */
+	{
+		std::vector<std::reference_wrapper<const Octree>> toVisit;
+		toVisit.reserve(OCTANTS_PER_NODE); // There is usually less than 8 octants to visit
+		toVisit.emplace_back(*this);
+
+		while (!toVisit.empty())
+		{
+			const auto& octree = toVisit.back().get();
+			toVisit.pop_back();
+
+			if (octree.isLeaf())
+			{
+				octree.forEachInsideLeaf(k, fn);
+				continue;
+			}
+
+			for (const auto& octant : octree.octants_)
+			{
+				switch (octant.classify(k))
+				{
+					case chs::Position::OUTSIDE: break;
+					case chs::Position::INSIDE: octant.forEachPoint(fn); break;
+					default: toVisit.emplace_back(octant);
+				}
+			}
+		}
+	}
+
 	public:
 	Octree();
 
@@ -53,7 +159,21 @@ class Octree
 
 	[[nodiscard]] inline auto getNumPoints() const { return points_.size(); }
 
-	inline void setPoints(const std::vector<Lpoint*>& points) { points_ = points; }
+	// Bytes taken by the tree, named after the cheesemap one so they can be compared
+	[[nodiscard]] inline size_t mem_footprint() const
+	{
+		size_t bytes = sizeof(*this) + points_.capacity() * sizeof(Lpoint*) +
+		               (octants_.capacity() - octants_.size()) * sizeof(Octree);
+		for (const auto& axis : coords_) { bytes += axis.capacity() * sizeof(double); }
+		for (const auto& octant : octants_) { bytes += octant.mem_footprint(); }
+		return bytes;
+	}
+
+	inline void setPoints(const std::vector<Lpoint*>& points)
+	{
+		clearPoints();
+		for (Lpoint* p : points) { addPoint(p); }
+	}
 	inline void setRadius(float radius) { radius_ = radius; }
 
 	[[nodiscard]] inline const Point& getMin() const { return min_; }
@@ -162,8 +282,8 @@ class Octree
 
 	[[nodiscard]] std::vector<Lpoint*> KNN(const Point& p, size_t k, size_t maxNeighs = DEFAULT_KNN) const;
 
-	template<typename Kernel, typename Function>
-	[[nodiscard]] std::vector<Lpoint*> neighbors(const Kernel& k, Function&& condition) const
+	template<chs::concepts::Kernel<chs::Point> Kernel_type, typename Function>
+	[[nodiscard]] std::vector<Lpoint*> neighbors(const Kernel_type& k, Function&& condition) const
 	/**
    * @brief Search neighbors function. Given kernel that already contains a point and a radius, return the points inside the region.
    * @param k specific kernel that contains the data of the region (center and radius)
@@ -173,33 +293,10 @@ class Octree
    */
 	{
 		std::vector<Lpoint*> ptsInside;
-
-		std::vector<std::reference_wrapper<const Octree>> toVisit;
-		toVisit.reserve(OCTANTS_PER_NODE); // There is usually less than 8 octants to visit
-		toVisit.emplace_back(*this);
-
-		while (!toVisit.empty())
-		{
-			const auto& octree = toVisit.back().get();
-			toVisit.pop_back();
-
-			if (octree.isLeaf())
-			{
-				for (Lpoint* point_ptr : octree.points_)
-				{
-					if (k.isInside(*point_ptr) && k.center().id() != point_ptr->id() && condition(*point_ptr))
-					{
-						ptsInside.emplace_back(point_ptr);
-					}
-				}
-			}
-			else
-			{
-				std::copy_if(std::begin(octree.octants_), std::end(octree.octants_), std::back_inserter(toVisit),
-				             [&](const Octree& octant) { return k.boxOverlap(octant.getCenter(), octant.getRadius()); });
-			}
-		}
-
+		forEachInside(k, [&](Lpoint* point_ptr) {
+			if (k.center().id() != point_ptr->id() && condition(*point_ptr)) { ptsInside.emplace_back(point_ptr); }
+		});
+		if constexpr (chs::concepts::SelectingKernel<Kernel_type, Lpoint>) { k.select(ptsInside); }
 		return ptsInside;
 	}
 
@@ -211,8 +308,9 @@ class Octree
 	[[nodiscard]] inline std::vector<Lpoint*> searchCylinderNeighbors(const Lpoint& p, const double radius,
 	                                                                  const double zMin, const double zMax) const
 	{
-		return searchNeighbors<Kernel_t::circle>(p, radius,
-		                                         [&](const Lpoint& p) { return p.getZ() >= zMin && p.getZ() <= zMax; });
+		constexpr auto dummyCondition = [](const Lpoint&) { return true; };
+		// open side, as the octree's circles, but zMin and zMax themselves are in
+		return neighbors(CenteredKernel<chs::kernels::Cylinder<false>>(p, radius, zMin, zMax), dummyCondition);
 	}
 
 	[[nodiscard]] inline std::vector<Lpoint*> searchCircleNeighbors(const Lpoint& p, const double radius) const
@@ -262,7 +360,8 @@ class Octree
    */
 	{
 		const auto kernel = kernelFactory<kernel_type>(p, radius);
-		return numNeighbors(kernel);
+		constexpr auto dummyCondition = [](const Lpoint&) { return true; };
+		return numNeighbors(kernel, dummyCondition);
 	}
 
 	template<Kernel_t kernel_type = Kernel_t::square, class Function>
@@ -280,65 +379,23 @@ class Octree
 		return numNeighbors(kernel, std::forward<Function&&>(condition));
 	}
 
-	template<typename Kernel>
-	[[nodiscard]] size_t numNeighbors(const Kernel& k) const
+	template<chs::concepts::Kernel<chs::Point> Kernel_type>
+	[[nodiscard]] size_t numNeighbors(const Kernel_type& k) const
 	{
 		size_t ptsInside = 0;
-
-		std::vector<std::reference_wrapper<const Octree>> toVisit;
-		toVisit.reserve(OCTANTS_PER_NODE); // There is usually less than 8 octants to visit
-		toVisit.emplace_back(*this);
-
-		while (!toVisit.empty())
-		{
-			const auto& octree = toVisit.back().get();
-			toVisit.pop_back();
-
-			if (octree.isLeaf())
-			{
-				for (Lpoint* point_ptr : octree.points_)
-				{
-					if (k.isInside(*point_ptr) && k.center().id() != point_ptr->id()) { ++ptsInside; }
-				}
-			}
-			else
-			{
-				std::copy_if(std::begin(octree.octants_), std::end(octree.octants_), std::back_inserter(toVisit),
-				             [&](const Octree& octant) { return k.boxOverlap(octant.getCenter(), octant.getRadius()); });
-			}
-		}
-
+		forEachInside(k, [&](Lpoint* point_ptr) {
+			if (k.center().id() != point_ptr->id()) { ++ptsInside; }
+		});
 		return ptsInside;
 	}
 
-	template<typename Kernel, typename Function>
-	[[nodiscard]] size_t numNeighbors(const Kernel& k, Function&& condition) const
+	template<chs::concepts::Kernel<chs::Point> Kernel_type, typename Function>
+	[[nodiscard]] size_t numNeighbors(const Kernel_type& k, Function&& condition) const
 	{
 		size_t ptsInside = 0;
-
-		std::vector<std::reference_wrapper<const Octree>> toVisit;
-		toVisit.reserve(OCTANTS_PER_NODE); // There is usually less than 8 octants to visit
-		toVisit.emplace_back(*this);
-
-		while (!toVisit.empty())
-		{
-			const auto& octree = toVisit.back().get();
-			toVisit.pop_back();
-
-			if (octree.isLeaf())
-			{
-				for (Lpoint* point_ptr : octree.points_)
-				{
-					if (k.isInside(*point_ptr) && k.center().id() != point_ptr->id() && condition(*point_ptr)) { ++ptsInside; }
-				}
-			}
-			else
-			{
-				std::copy_if(std::begin(octree.octants_), std::end(octree.octants_), std::back_inserter(toVisit),
-				             [&](const Octree& octant) { return k.boxOverlap(octant.getCenter(), octant.getRadius()); });
-			}
-		}
-
+		forEachInside(k, [&](Lpoint* point_ptr) {
+			if (k.center().id() != point_ptr->id() && condition(*point_ptr)) { ++ptsInside; }
+		});
 		return ptsInside;
 	}
 
@@ -362,7 +419,7 @@ class Octree
 		const auto outerKernel = kernelFactory<Kernel_t::cube>(p, outerRingRadii);
 		// But not too close (within "innerRingRadii")
 		const auto innerKernel = kernelFactory<Kernel_t::cube>(p, innerRingRadii);
-		const auto condition   = [&](const Point& point) { return !innerKernel.isInside(point); };
+		const auto condition   = [&](const Point& point) { return !innerKernel.is_inside(point); };
 
 		return neighbors(outerKernel, condition);
 	}
@@ -383,7 +440,8 @@ class Octree
 	[[nodiscard]] std::vector<Lpoint*> searchConnectedShellNeighbors(const Point& point, float nextDoorDistance,
 	                                                                 float minRadius, float maxRadius) const;
 
-	/** Connected circle neighbors*/
+	/** Connected circle neighbors. Grows a single cluster serially; chs::euclidean_clusters labels every cluster of a
+	 * map at once, in parallel */
 	std::vector<Lpoint*> searchEraseConnectedCircleNeighbors(float nextDoorDistance);
 
 	static std::vector<Lpoint*> connectedNeighbors(const Point* point, std::vector<Lpoint*>& neighbors,
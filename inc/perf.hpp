@@ -0,0 +1,70 @@
+//
+// Hardware performance counters per pipeline phase, read with perf_event_open
+//
+
+#pragma once
+
+#include <string>
+
+enum PerfPhase
+{
+	PERF_READ = 0, // reading the points of the rank
+	PERF_BUILD,    // building the maps
+	PERF_QUERY,    // neighbourhood searches, reported without the features computed from them
+	PERF_FEATURES, // features of every point, from its neighbours
+	PERF_WRITE,    // writing the descriptors
+	PERF_PHASE_COUNT
+};
+
+// Cycles, instructions, LLC load misses and dTLB load misses
+constexpr int PERF_EVENT_COUNT = 4;
+
+/**
+ * @brief Opens the counters of every OpenMP thread, user space only.
+ * Counters the kernel or the hardware do not offer are reported as -1, as are all of them when none can be opened
+ * (e.g. perf_event_paranoid too high or no PMU under a VM).
+ * @return Whether any counter could be opened
+ */
+bool enablePerf();
+
+/**
+ * @brief Scoped counting of a phase. Without enablePerf() it only checks a flag.
+ *
+ * Regions built with thread = false count all the OpenMP threads at once and must be entered outside parallel
+ * regions. Those built with thread = true count only the calling thread, and are meant for the body of parallel
+ * loops.
+ */
+class PerfRegion
+{
+	PerfPhase phase_;
+	bool      thread_;
+	bool      open_{};
+	double    start_[PERF_EVENT_COUNT]{};
+
+	void begin();
+	void end();
+
+	public:
+	explicit PerfRegion(PerfPhase phase, bool thread = false) : phase_(phase), thread_(thread)
+	{
+		if (perfEnabled) { begin(); }
+	}
+	~PerfRegion() { stop(); }
+
+	// Closes the region before the end of its scope
+	void stop()
+	{
+		if (open_) { end(); }
+	}
+
+	PerfRegion(const PerfRegion&)            = delete;
+	PerfRegion& operator=(const PerfRegion&) = delete;
+
+	static inline bool perfEnabled = false;
+};
+
+/**
+ * @brief Counts of every phase, as comma separated columns for the debug CSV: cycles, instructions, LLC misses and
+ * dTLB misses of read, build, query, features and write, in that order. -1 where not measured.
+ */
+std::string perfColumns();
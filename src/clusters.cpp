@@ -0,0 +1,119 @@
+//
+// Euclidean clusters across boxes and ranks: every box labels its own clusters, then the labels of the points that
+// several boxes hold are merged
+//
+
+#include "clusters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <mpi.h>
+#include <tuple>
+
+void boundaryRecords(const std::vector<Lpoint>& points, const Box& box, const double distance,
+                     std::vector<ClusterRecord>& records)
+{
+	for (const auto& p : points)
+	{
+		// distance to the closest side, negative outside of the box
+		const double border = std::min({ p.getX() - box.minX(), box.maxX() - p.getX(), p.getY() - box.minY(),
+		                                 box.maxY() - p.getY() });
+		if (std::abs(border) <= distance) { records.push_back({ p.getX(), p.getY(), p.getZ(), p.cluster }); }
+	}
+}
+
+namespace
+{
+	// Union-find over the labels found in the records, each set rooted at its smallest label
+	struct LabelSets
+	{
+		std::unordered_map<uint64_t, uint64_t> parent;
+
+		uint64_t find(uint64_t label)
+		{
+			auto it = parent.try_emplace(label, label).first;
+			while (it->second != label)
+			{
+				auto next  = parent.find(it->second);
+				it->second = next->second; // path halving
+				label      = it->second;
+				it         = parent.find(label);
+			}
+			return label;
+		}
+
+		void unite(uint64_t a, uint64_t b)
+		{
+			a = find(a);
+			b = find(b);
+			if (a != b) { parent[std::max(a, b)] = std::min(a, b); }
+		}
+	};
+
+	// MPI type of a ClusterRecord, so that counts and displacements are in records instead of bytes
+	MPI_Datatype recordType()
+	{
+		const int          lengths[] = { 3, 1 };
+		const MPI_Aint     offsets[] = { offsetof(ClusterRecord, x), offsetof(ClusterRecord, label) };
+		const MPI_Datatype types[]   = { MPI_DOUBLE, MPI_UINT64_T };
+
+		MPI_Datatype fields, record;
+		MPI_Type_create_struct(2, lengths, offsets, types, &fields);
+		MPI_Type_create_resized(fields, 0, sizeof(ClusterRecord), &record);
+		MPI_Type_free(&fields);
+		MPI_Type_commit(&record);
+		return record;
+	}
+} // namespace
+
+std::unordered_map<uint64_t, uint64_t> mergeClusters(const std::vector<ClusterRecord>& records)
+{
+	int rank = 0, npes = 1;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &npes);
+
+	// get counts and displacements for MPI_Gatherv, in records: ints hold up to 2^31 of them, 64 GiB on rank 0
+	MPI_Datatype recordT = recordType();
+	int count = records.size();
+	std::vector<int> counts(npes), displs(npes);
+	MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+	for (int i = 1; i < npes; i++) { displs[i] = displs[i - 1] + counts[i - 1]; }
+
+	std::vector<ClusterRecord> all;
+	if (rank == 0) { all.resize(displs[npes - 1] + counts[npes - 1]); }
+	MPI_Gatherv(records.data(), count, recordT, all.data(), counts.data(), displs.data(), recordT, 0, MPI_COMM_WORLD);
+	MPI_Type_free(&recordT);
+
+	// (label, new label) pairs
+	std::vector<std::pair<uint64_t, uint64_t>> joined;
+	if (rank == 0)
+	{
+		// copies of a point read for several boxes keep its exact coordinates, so they end up next to each other
+		const auto coords = [](const ClusterRecord& r) { return std::tie(r.x, r.y, r.z); };
+		std::sort(all.begin(), all.end(),
+		          [&](const ClusterRecord& a, const ClusterRecord& b) { return coords(a) < coords(b); });
+
+		LabelSets sets;
+		for (size_t i = 1; i < all.size(); i++)
+		{
+			if (coords(all[i]) == coords(all[i - 1])) { sets.unite(all[i].label, all[i - 1].label); }
+		}
+		for (auto& [label, parent] : sets.parent)
+		{
+			if (const auto root = sets.find(label); root != label) { joined.emplace_back(label, root); }
+		}
+	}
+
+	// sent as pairs of uint64_t, counted in pairs as well
+	MPI_Datatype pairT;
+	MPI_Type_contiguous(2, MPI_UINT64_T, &pairT);
+	MPI_Type_commit(&pairT);
+	count = joined.size();
+	MPI_Bcast(&count, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	joined.resize(count);
+	MPI_Bcast(joined.data(), count, pairT, 0, MPI_COMM_WORLD);
+	MPI_Type_free(&pairT);
+
+	return { joined.begin(), joined.end() };
+}
@@ -110,7 +110,7 @@ std::pair<Point, Point> readBoundingBox(const fs::path& filename)
 
 	File_t readerType = chooseReaderType(fExt);
 
-	if (readerType == err_t || readerType == txt_t)
+	if (readerType == err_t)
 	{
 		std::cout << "Uncompatible file format\n";
 		exit(-1);
@@ -139,7 +139,8 @@ void writePointCloud(const fs::path& fileName, std::vector<Lpoint>& points)
 	fileWriter->write(points);
 }
 
-void writePointCloudDescriptors(const fs::path& fileName, std::vector<Lpoint>& points)
+void writePointCloudDescriptors(const fs::path& fileName, std::vector<Lpoint>& points, const bool clusters,
+                                const bool filtered)
 {
 	// get output file extension
 	auto fExt = fileName.extension();
@@ -152,7 +153,7 @@ void writePointCloudDescriptors(const fs::path& fileName, std::vector<Lpoint>& p
 		exit(-1);
 	}
 
-	std::shared_ptr<FileWriter> fileWriter = FileWriterFactory::makeWriter(writerType, fileName);
+	std::shared_ptr<FileWriter> fileWriter = FileWriterFactory::makeWriter(writerType, fileName, clusters, filtered);
 
 	fileWriter->writeDescriptors(points);
 }
\ No newline at end of file
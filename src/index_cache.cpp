@@ -0,0 +1,59 @@
+//
+// On-disk cache of the cheesemap of every box, keyed by what the map depends on
+//
+
+#include "index_cache.hpp"
+#include <chrono>
+#include <system_error>
+
+namespace
+{
+	// FNV-1a, stable across runs and builds unlike std::hash
+	struct Fnv1a
+	{
+		uint64_t hash = 0xcbf29ce484222325ULL;
+
+		void add(const void* data, size_t size)
+		{
+			const auto* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 0x100000001b3ULL;
+			}
+		}
+
+		template<typename T>
+		void add(const T& value)
+		{
+			add(&value, sizeof(value));
+		}
+	};
+} // namespace
+
+uint64_t indexFingerprint(const fs::path& input, int npes, int rank, unsigned box, float overlap, size_t npoints,
+                          const std::array<double, 3>& res, size_t flags)
+{
+	std::error_code ec;
+	const std::string path  = fs::weakly_canonical(input, ec).string();
+	const uintmax_t   size  = fs::file_size(input, ec);
+	const auto        mtime = fs::last_write_time(input, ec).time_since_epoch().count();
+
+	Fnv1a fnv;
+	fnv.add(path.data(), path.size());
+	fnv.add(size);
+	fnv.add(mtime);
+	fnv.add(npes);
+	fnv.add(rank);
+	fnv.add(box);
+	fnv.add(overlap);
+	fnv.add(npoints);
+	fnv.add(res);
+	fnv.add(flags);
+	return fnv.hash;
+}
+
+fs::path indexCachePath(const fs::path& dir, const std::string& fileName, int rank, unsigned box)
+{
+	return dir / (fileName + "_r" + std::to_string(rank) + "_b" + std::to_string(box) + ".csr");
+}
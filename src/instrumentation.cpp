@@ -0,0 +1,248 @@
+//
+// Timing regions and counters, aggregated per thread and rank
+//
+
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mpi.h>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	const clock::time_point origin = clock::now();
+
+	const char* const counterNames[COUNTER_COUNT] = { "points_read", "queries", "cells_visited", "candidates_tested",
+		                                              "neighbors_found", "points_filtered" };
+
+	struct Stat
+	{
+		uint64_t calls{};
+		double   seconds{};
+	};
+
+	struct Event
+	{
+		std::string path;
+		double      begin{}; // seconds since origin
+		double      end{};
+	};
+
+	// Everything recorded by one thread, only touched by it until writeProfile
+	struct ThreadLog
+	{
+		size_t                      tid{};
+		std::vector<const char*>    stack; // open regions
+		std::map<std::string, Stat> stats;
+		std::vector<Event>          events;
+	};
+
+	std::mutex                                       logsMutex;
+	std::vector<std::unique_ptr<ThreadLog>>          logs;
+	std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+	bool                                             tracing = false;
+
+	ThreadLog& threadLog()
+	{
+		thread_local ThreadLog* log = [] {
+			std::lock_guard lock(logsMutex);
+			logs.push_back(std::make_unique<ThreadLog>());
+			logs.back()->tid = logs.size() - 1;
+			return logs.back().get();
+		}();
+		return *log;
+	}
+
+	double since(const clock::time_point t) { return std::chrono::duration<double>(t - origin).count(); }
+
+	/**
+	 * @brief Gathers the text of every rank at rank 0, empty elsewhere
+	 */
+	std::vector<std::string> gatherText(const std::string& text, int rank, int npes)
+	{
+		int size = static_cast<int>(text.size());
+		std::vector<int> sizes(npes), displs(npes, 0);
+		MPI_Gather(&size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+		std::string all;
+		if (rank == 0)
+		{
+			for (int r = 1; r < npes; r++) { displs[r] = displs[r - 1] + sizes[r - 1]; }
+			all.resize(displs[npes - 1] + sizes[npes - 1]);
+		}
+		MPI_Gatherv(text.data(), size, MPI_CHAR, all.data(), sizes.data(), displs.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+
+		std::vector<std::string> texts;
+		if (rank == 0)
+		{
+			for (int r = 0; r < npes; r++) { texts.push_back(all.substr(displs[r], sizes[r])); }
+		}
+		return texts;
+	}
+} // namespace
+
+Region::Region(const char* name, bool trace) : name_(name), trace_(trace)
+{
+	if (trace_) { threadLog().stack.push_back(name_); }
+	start_ = clock::now();
+}
+
+double Region::stop()
+{
+	if (!open_) { return 0; }
+	open_ = false;
+
+	const auto end     = clock::now();
+	const auto seconds = std::chrono::duration<double>(end - start_).count();
+
+	ThreadLog& log = threadLog();
+	if (!trace_)
+	{
+		Stat& stat = log.stats[name_];
+		stat.calls++;
+		stat.seconds += seconds;
+		return seconds;
+	}
+
+	std::string path;
+	for (const char* name : log.stack) { path += (path.empty() ? "" : "/") + std::string(name); }
+
+	Stat& stat = log.stats[path];
+	stat.calls++;
+	stat.seconds += seconds;
+	if (tracing) { log.events.push_back({ path, since(start_), since(end) }); }
+
+	log.stack.pop_back();
+	return seconds;
+}
+
+void count(Counter counter, uint64_t n) { counters[counter].fetch_add(n, std::memory_order_relaxed); }
+
+void enableTracing() { tracing = true; }
+
+void writeProfile(const fs::path& dir, const std::string& name)
+{
+	int rank = 0, npes = 1;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &npes);
+
+	// Per region path of this rank: calls, seconds over all threads, and the least and most of a single thread
+	struct RankStat
+	{
+		uint64_t calls{};
+		double   seconds{}, threadMin{ 1e300 }, threadMax{};
+	};
+	std::map<std::string, RankStat> local;
+	std::ostringstream              events;
+	events << std::setprecision(17);
+	for (const auto& log : logs)
+	{
+		for (const auto& [path, stat] : log->stats)
+		{
+			RankStat& s = local[path];
+			s.calls += stat.calls;
+			s.seconds += stat.seconds;
+			s.threadMin = std::min(s.threadMin, stat.seconds);
+			s.threadMax = std::max(s.threadMax, stat.seconds);
+		}
+		for (const auto& e : log->events)
+		{
+			events << log->tid << '\t' << e.begin << '\t' << e.end << '\t' << e.path << '\n';
+		}
+	}
+
+	std::ostringstream stats;
+	stats << std::setprecision(17);
+	for (const auto& [path, s] : local)
+	{
+		stats << s.calls << '\t' << s.seconds << '\t' << s.threadMin << '\t' << s.threadMax << '\t' << path << '\n';
+	}
+	const auto allStats = gatherText(stats.str(), rank, npes);
+
+	std::array<uint64_t, COUNTER_COUNT> values{}, sums{}, maxs{};
+	for (int c = 0; c < COUNTER_COUNT; c++) { values[c] = counters[c].load(); }
+	MPI_Reduce(values.data(), sums.data(), COUNTER_COUNT, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+	MPI_Reduce(values.data(), maxs.data(), COUNTER_COUNT, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+
+	const auto allEvents = tracing ? gatherText(events.str(), rank, npes) : std::vector<std::string>{};
+
+	if (rank != 0) { return; }
+
+	// Merge the ranks: seconds of each rank as a whole, and of its threads
+	struct GlobalStat
+	{
+		uint64_t calls{};
+		int      ranks{};
+		double   seconds{}, rankMin{ 1e300 }, rankMax{}, threadMin{ 1e300 }, threadMax{};
+	};
+	std::map<std::string, GlobalStat> global;
+	for (const auto& text : allStats)
+	{
+		std::istringstream in(text);
+		RankStat           s;
+		std::string        path;
+		while (in >> s.calls >> s.seconds >> s.threadMin >> s.threadMax && std::getline(in >> std::ws, path))
+		{
+			GlobalStat& g = global[path];
+			g.calls += s.calls;
+			g.ranks++;
+			g.seconds += s.seconds;
+			g.rankMin   = std::min(g.rankMin, s.seconds);
+			g.rankMax   = std::max(g.rankMax, s.seconds);
+			g.threadMin = std::min(g.threadMin, s.threadMin);
+			g.threadMax = std::max(g.threadMax, s.threadMax);
+		}
+	}
+
+	std::ofstream out(dir / (name + "_profile.json"));
+	out << std::setprecision(9);
+	out << "{\n  \"ranks\": " << npes << ",\n  \"regions\": {";
+	bool first = true;
+	for (const auto& [path, g] : global)
+	{
+		out << (first ? "\n" : ",\n") << "    \"" << path << "\": { \"calls\": " << g.calls << ", \"ranks\": " << g.ranks
+		    << ", \"seconds\": " << g.seconds << ", \"rank_min\": " << g.rankMin
+		    << ", \"rank_mean\": " << g.seconds / g.ranks << ", \"rank_max\": " << g.rankMax
+		    << ", \"thread_min\": " << g.threadMin << ", \"thread_max\": " << g.threadMax << " }";
+		first = false;
+	}
+	out << "\n  },\n  \"counters\": {";
+	for (int c = 0; c < COUNTER_COUNT; c++)
+	{
+		out << (c ? ",\n" : "\n") << "    \"" << counterNames[c] << "\": { \"sum\": " << sums[c]
+		    << ", \"rank_max\": " << maxs[c] << " }";
+	}
+	out << "\n  }\n}\n";
+	out.close();
+
+	if (!tracing) { return; }
+
+	std::ofstream trace(dir / (name + "_trace.json"));
+	trace << std::fixed << std::setprecision(3);
+	trace << "{\"traceEvents\": [";
+	first = true;
+	for (int r = 0; r < npes; r++)
+	{
+		std::istringstream in(allEvents[r]);
+		size_t             tid;
+		double             begin, end;
+		std::string        path;
+		while (in >> tid >> begin >> end && std::getline(in >> std::ws, path))
+		{
+			trace << (first ? "\n" : ",\n") << "{\"name\": \"" << path << "\", \"ph\": \"X\", \"pid\": " << r
+			      << ", \"tid\": " << tid << ", \"ts\": " << 1e6 * begin << ", \"dur\": " << 1e6 * (end - begin) << "}";
+			first = false;
+		}
+	}
+	trace << "\n]}\n";
+	trace.close();
+}
@@ -5,17 +5,26 @@
 #include <iomanip>
 #include <iostream>
 #include <fstream>
-#include "TimeWatcher.hpp"
+#include "instrumentation.hpp"
 #include <cmath>
 #include "decimation.hpp"
 #include "cheesemap/cheesemap.hpp"
 #include <mpi.h>
+#include <omp.h>
 #include "partitions.hpp"
 #include "Box.hpp"
-#include <fstream>
+#include "numa.hpp"
+#include "perf.hpp"
+#include "index_cache.hpp"
+#include "clusters.hpp"
+#include <optional>
+#include <variant>
 
 namespace fs = std::filesystem;
 
+// Points whose features a thread computes at once, see describe in main
+constexpr size_t FEATURE_CHUNK = 64;
+
 Lpoint centroid(const std::vector<Lpoint>& points);
 
 arma::mat cov(const std::vector<Lpoint>& points);
@@ -32,18 +41,50 @@ int main(int argc, char* argv[])
 
 	if (!mainOptions.outputDirName.empty()) { mainOptions.outputDirName = mainOptions.outputDirName / fileName; }
 	createDirectory(mainOptions.outputDirName);
+	if (!mainOptions.indexCache.empty()) { createDirectory(mainOptions.indexCache); }
+	// clusters are only joined across boxes through their overlap, as wide as the radius
+	if (mainOptions.clusterDist > mainOptions.radius)
+	{
+		mainOptions.clusterDist = mainOptions.radius;
+		std::cout << "Euclidean clustering distance clamped to the search radius: " << mainOptions.clusterDist << "\n";
+	}
+	// outliers at the border of a box count the neighbors in its overlap too, widened by this radius
+	if (mainOptions.outlierRadius <= 0 || mainOptions.outlierRadius > mainOptions.radius)
+	{
+		mainOptions.outlierRadius = mainOptions.radius;
+	}
 
 	// Print three decimals
 	std::cout << std::fixed;
 	std::cout << std::setprecision(3);
 
-	TimeWatcher tw;
-
 	// init MPI
 	int rank = 0, npes = 1;
 	MPI_Init(&argc, &argv);
 	MPI_Comm_size(MPI_COMM_WORLD, &npes);
 	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	if (mainOptions.trace) { enableTracing(); }
+	Region total("total");
+
+	// ranks sharing this node, ideally one per NUMA node (socket)
+	MPI_Comm nodeComm;
+	int nodeRank = 0, nodeSize = 1;
+	MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+	MPI_Comm_rank(nodeComm, &nodeRank);
+	MPI_Comm_size(nodeComm, &nodeSize);
+	MPI_Comm_free(&nodeComm);
+	const int nodes = numaNodes();
+	if (nodeRank == 0 && nodeSize < nodes)
+	{
+		std::cout << "Warning: " << nodeSize << " ranks on a node with " << nodes << " NUMA nodes, "
+				  << "running one rank per NUMA node avoids remote memory accesses\n";
+	}
+	if (!mainOptions.bind.empty()) { bindThreads(mainOptions.bind, nodeRank, nodeSize); }
+	// opened from the threads themselves, so after pinning them
+	if (mainOptions.perf && !enablePerf())
+	{
+		std::cout << rank << ": Hardware counters not available, check perf_event_paranoid\n";
+	}
 
 	std::vector<Lpoint> points;
 	std::vector<std::pair<Point, Point>> boxes;
@@ -54,27 +95,35 @@ int main(int argc, char* argv[])
 		// decimation (only if stated as such, easier doing it on 1 node)
 		if (mainOptions.dec > 0)
 		{
-			tw.start();
+			Region read("decimation_read");
 			points = readPointCloud(inputFile);		// TODO: decimate in read, then move this to dec > 0
-			tw.stop();
 			std::cout << "Number of read points: " << points.size() << "\n";
-			std::cout << "Time to read points: " << tw.getElapsedDecimalSeconds() << " seconds\n";
+			std::cout << "Time to read points: " << read.stop() << " seconds\n";
 			decimateAndRotate(points, mainOptions.dec);
 
 			string ext = (mainOptions.zip) ? ".laz" : ".las";
 			fs::path outputFile = mainOptions.outputDirName / (fileName + ext);
-			tw.start();
+			Region write("decimation_write");
 			writePointCloud(outputFile, points);
-			tw.stop();
-			std::cout << "Time to write point cloud: " << tw.getElapsedDecimalSeconds() << " seconds\n";
+			std::cout << "Time to write point cloud: " << write.stop() << " seconds\n";
 
 			inputFile = outputFile;
 		}
 
+		// columnar copy of the input, so later runs can read it back without decoding
+		if (mainOptions.exportCol && inputFile.extension() != ".col")
+		{
+			Region convert("convert_col");
+			points = readPointCloud(inputFile);
+			writePointCloud(mainOptions.outputDirName / (fileName + ".col"), points);
+			std::cout << "Time to convert point cloud to columnar format: " << convert.stop() << " seconds\n";
+			points.clear();
+		}
+
 		// get point cloud bounding box, split it
 		if (mainOptions.radius > 0)
 		{
-			tw.start();
+			Region partition("partition");
 			auto minmax = readBoundingBox(inputFile);
 			if (npes == 1) boxes.emplace_back(minmax);
 			else
@@ -84,8 +133,7 @@ int main(int argc, char* argv[])
 				// boxes = cellPart(minmax, npes, points);	// points passed are always not decimated
 				// boxes = cellMergePart(minmax, npes, points);
 				boxes = quadPart(minmax, npes, points);
-				tw.stop();
-				partt = tw.getElapsedDecimalSeconds();
+				partt = partition.stop();
 				std::cout << "Time to partition point cloud: " << partt << " seconds\n";
 			}
 		}
@@ -93,9 +141,18 @@ int main(int argc, char* argv[])
 		points.clear();
 	}
 
+	if (mainOptions.exportCol && inputFile.extension() != ".col")
+	{
+		Region wait("mpi_wait_col");
+		MPI_Barrier(MPI_COMM_WORLD);	// wait for rank 0 to write it
+		wait.stop();
+		inputFile = mainOptions.outputDirName / (fileName + ".col");
+	}
+
 	if (mainOptions.radius > 0)
 	{
 		// get sendcounts and displacements for MPI_Scatterv, then send data as MPI_BYTE
+		Region scatter("mpi_scatter_boxes");
 		int boxsize = (rank == 0) ? boxes.size() : 0;
 		MPI_Bcast(&boxsize, 1, MPI_INT, 0, MPI_COMM_WORLD);
 		std::vector<int> sendcounts(npes, std::ceil(static_cast<double>(boxsize)/npes));
@@ -118,87 +175,305 @@ int main(int argc, char* argv[])
 		lboxes.resize(sendcounts[rank]/pairsize);
 		MPI_Scatterv(boxes.data(), sendcounts.data(), displs.data(), MPI_BYTE, lboxes.data(), sendcounts[rank], MPI_BYTE, 0, MPI_COMM_WORLD);
 		lboxes.shrink_to_fit();
+		scatter.stop();
 
-		const float rad = mainOptions.radius;	// search radius
+		const float rad = mainOptions.radius;	// search radius, the maximum one in adaptive mode
+		const bool filtering = mainOptions.sorRatio > 0 || mainOptions.rorNeighbors > 0;
+		// overlap points up to rad away can be neighbors, and with outliers filtered all their own neighbors are read
+		const float halo = filtering ? rad + mainOptions.outlierRadius : rad;
 		std::vector<Box> boxboxes;
 		std::vector<Box> overlaps;
 		for (int i = 0; i < lboxes.size(); i++)
 		{
 			boxboxes.emplace_back(lboxes[i]);
-			overlaps.emplace_back(std::pair<Point, Point>(lboxes[i].first - rad, lboxes[i].second + rad));
+			overlaps.emplace_back(std::pair<Point, Point>(lboxes[i].first - halo, lboxes[i].second + halo));
 		}
 		unsigned int npoints = 0, nover = 0, ncells = 0, nempty = 0;	// for debug output
+		unsigned int nfiltered = 0;	// outliers left out of the descriptors
 		double readt = 0, cheeset = 0, desct = 0;
+		double radsum = 0;	// sum of the radii used, to report the mean
+		std::string maptypes;	// map chosen for each box
+		std::string cellsizes;	// x/y cell size used for each box
 		// read points
-		tw.start();
+		Region read("read");
+		PerfRegion perfRead(PERF_READ);
 		std::vector<std::vector<Lpoint>> lpoints = readPointCloudOverlap(inputFile, boxboxes, overlaps);
-		tw.stop();
-		readt = tw.getElapsedDecimalSeconds();
+		perfRead.stop();
+		readt = read.stop();
+		// readers fill the points from one thread, spread their pages over all the sockets of the rank querying them
+		if (nodes > 1)
+		{
+			Region spread("interleave");
+			for (auto& points : lpoints) { interleave(points); }
+		}
 		boxboxes.clear();
 		overlaps.clear();
 		std::vector<Lpoint> totPoints;	// vector to append points to after each iteration
+		std::vector<ClusterRecord> borders;	// points joining the clusters of different boxes
+		chs::Arena arena;				// cells of the map of each box, rewound between boxes
+		const std::pmr::polymorphic_allocator<Lpoint*> alloc(&arena);
 		unsigned short part = rank;		// this is just to save to point cloud
 		for (auto& points : lpoints)
 		{
+			Region box("box");
 			#pragma omp parallel for reduction(+:nover)
 			for (auto& p : points) { if (p.overlap) nover++; }
 			npoints += points.size();
+			count(POINTS_READ, points.size());
 			// debstr += std::to_string(points.size()) + ", " + std::to_string(nover) + ", ";
 
-			// cheesemap
+			// cheesemap, type picked from the cell occupancy of the box unless forced with --map
 			std::cout << "Building global cheesemap..." << std::endl;
-			tw.start();
-			const auto flags = chs::flags::build::PARALLEL | chs::flags::build::SHRINK_TO_FIT;
-			auto map = chs::Dense<Lpoint, 2>(points, mainOptions.cellSize, flags);
-			tw.stop();
-			std::cout << rank << ": Time to build global cheesemap of " << points.size() << ": " << tw.getElapsedDecimalSeconds() << " seconds\n";
-
-			const auto bytes = map.mem_footprint();
-			const auto mb    = bytes / (1024.0 * 1024.0);
-			std::cout << "Estimated mem. footprint: " << map.mem_footprint() << " Bytes (" << mb << "MB)" << '\n';
-
-			std::cout << "Number of cells: " << map.get_num_cells() << ", of which, empty: " << map.get_empty_cells() << "\n";
-			cheeset += tw.getElapsedDecimalSeconds();
-			ncells += map.get_num_cells();
-			nempty += map.get_empty_cells();
-			// debstr += std::to_string(tw.getElapsedDecimalSeconds()) + ", " +
-			// 		std::to_string(map.get_num_cells()) + ", " + std::to_string(map.get_empty_cells()) + ", ";
-
-			// neigh search
-			tw.start();
-			#pragma omp parallel for
-			for (auto& p : points)
+			Region build("build");
+			PerfRegion perfBuild(PERF_BUILD);
+			auto res = chs::n_array<3>(static_cast<double>(mainOptions.cellSize));
+			if (mainOptions.autoCellSize) { res = chs::MapFactory::tune<Lpoint>(points, rad, mainOptions.tuneBench); }
+			auto choice = chs::MapFactory::choose(points, res, rad);
+			const auto forced = chs::map_from_string(mainOptions.mapType);
+			if (forced != chs::map_t::AUTO) { choice.type = forced; }
+			// columns of the 2D maps sorted by z, so that the spheres skip the points far above or below them
+			const auto flags = chs::flags::build::PARALLEL | chs::flags::build::SHRINK_TO_FIT | chs::flags::build::SORT_Z;
+			arena.reset();	// the map of the previous box is gone by now
+			// CSR maps are mapped back from the cache when saved for the same input, box and cell size
+			const bool cached = !mainOptions.indexCache.empty() && choice.type == chs::map_t::CSR;
+			fs::path cacheFile;
+			uint64_t fingerprint = 0;
+			std::optional<chs::DenseCSR<Lpoint, 2>> loaded;
+			if (cached)
 			{
-				if (p.overlap) continue;
-				chs::kernels::Sphere<3> search(p, rad);
-				const auto results_map = map.query(search);	// vector with neighs of P inside a sphere of radius rads
-				std::vector<Lpoint> neigh{};	// quick conversion to Lpoint vector
-				for (auto m : results_map) { neigh.push_back(Lpoint(m[0][0], m[0][1], m[0][2])); }
-				features(neigh, p);
-				p.part = part;
+				cacheFile   = indexCachePath(mainOptions.indexCache, fileName, rank, part);
+				fingerprint = indexFingerprint(inputFile, npes, rank, part, halo, points.size(), res, flags);
+				loaded      = chs::DenseCSR<Lpoint, 2>::load(cacheFile, points, fingerprint);
 			}
-			tw.stop();
-			std::cout << "Time to calculate descriptors: " << tw.getElapsedDecimalSeconds() << " seconds\n";
-			// debstr += std::to_string(tw.getElapsedDecimalSeconds()) + ", ";
-			desct += tw.getElapsedDecimalSeconds();
+			using AnyMap = chs::AnyMap<Lpoint, std::pmr::polymorphic_allocator<Lpoint*>>;
+			auto anymap = loaded ? AnyMap{ std::in_place_type<chs::DenseCSR<Lpoint, 2>>, std::move(*loaded) }
+			                     : chs::MapFactory::make<Lpoint>(points, choice, flags, alloc);
+			perfBuild.stop();
+			const double buildt = build.stop();
+			std::cout << rank << ": Time to " << (loaded ? "load" : "build") << " global cheesemap ("
+					  << chs::to_string(choice.type) << ") of " << points.size() << ": " << buildt << " seconds\n";
+			if (cached && !loaded)
+			{
+				Region save("save_index");
+				try
+				{
+					std::get<chs::DenseCSR<Lpoint, 2>>(anymap).save(cacheFile, points, fingerprint);
+				}
+				catch (const std::exception& e)
+				{
+					std::cout << rank << ": Cannot save the map to the index cache: " << e.what() << "\n";
+				}
+			}
+			std::cout << "Cell size: " << res[0] << " x " << res[1] << " x " << res[2] << "\n";
+			std::cout << "Cell occupancy: " << 100 * choice.occupancy.empty_ratio() << "% empty, "
+					  << choice.occupancy.mean_occupancy() << " points per occupied cell, "
+					  << choice.occupancy.candidates_per_query() << " expected candidates per query\n";
+			cheeset += buildt;
+			maptypes += (maptypes.empty() ? "" : "/") + std::string(chs::to_string(choice.type));
+			cellsizes += (cellsizes.empty() ? "" : "/") + std::to_string(res[0]);
+
+			std::visit([&](auto& map) {
+				const auto bytes = map.mem_footprint();
+				const auto mb    = bytes / (1024.0 * 1024.0);
+				std::cout << "Estimated mem. footprint: " << bytes << " Bytes (" << mb << "MB)" << '\n';
+
+				std::cout << "Number of cells: " << map.get_num_cells() << ", of which, empty: " << map.get_empty_cells() << "\n";
+				ncells += map.get_num_cells();
+				nempty += map.get_empty_cells();
+				// debstr += std::to_string(tw.getElapsedDecimalSeconds()) + ", " +
+				// 		std::to_string(map.get_num_cells()) + ", " + std::to_string(map.get_empty_cells()) + ", ";
+
+				// neigh search, batched so that queries from the same cell share their candidates
+				Region descriptors("descriptors");
+				PerfRegion perfQuery(PERF_QUERY);
+				std::vector<size_t> targets;	// points outside the overlap
+				targets.reserve(points.size());
+				for (size_t i = 0; i < points.size(); i++) { if (!points[i].overlap) targets.push_back(i); }
+
+				// how far a point lies outside of the box, negative inside
+				const Box own(lboxes[&points - lpoints.data()]);
+				const auto outside = [&](const Lpoint& p) {
+					return -std::min({ p.getX() - own.minX(), own.maxX() - p.getX(), p.getY() - own.minY(),
+					                   own.maxY() - p.getY() });
+				};
+
+				// outliers of the box and of the overlap up to rad away, which can be neighbors of the box. These
+				// overlap points have all their neighbors read, so they are judged as in their own box, although
+				// with the SOR statistics of this one, taken over the points of the box alone
+				if (filtering)
+				{
+					Region filter("outliers");
+					const chs::Outliers outliers{ mainOptions.outlierRadius, mainOptions.rorNeighbors,
+					                              mainOptions.sorRatio };
+					std::vector<size_t> tested = targets;
+					for (size_t i = 0; i < points.size(); i++)
+					{
+						if (points[i].overlap && outside(points[i]) <= rad) { tested.push_back(i); }
+					}
+					const auto testedPoints = tested | ranges::views::transform([&](const size_t i) -> const Lpoint& {
+						return points[i];
+					});
+					const auto counts = chs::neighbour_counts(map, testedPoints, outliers.radius);
+					const double threshold =
+					        chs::outlier_threshold(outliers, counts | ranges::views::take(targets.size()));
+					size_t kept = 0;
+					for (size_t q = 0; q < tested.size(); q++)
+					{
+						if (counts[q] < threshold) { points[tested[q]].filtered = true; }
+						else if (q < targets.size()) { targets[kept++] = targets[q]; }
+					}
+					nfiltered += targets.size() - kept;
+					count(POINTS_FILTERED, targets.size() - kept);
+					std::cout << "Outliers filtered: " << targets.size() - kept << " of " << targets.size()
+							  << " points in " << filter.stop() << " seconds\n";
+					targets.resize(kept);
+				}
+
+				// features are computed for chunks of points of each thread, so they are timed and counted once per
+				// chunk instead of once per point
+				struct PendingFeatures
+				{
+					std::vector<std::vector<Lpoint>> neigh;	// quick conversion to Lpoint vectors, reused between chunks
+					std::vector<size_t> targets;
+					size_t size = 0;
+				};
+				std::vector<PendingFeatures> pending(omp_get_max_threads());
+				const auto computeFeatures = [&](PendingFeatures& work) {
+					if (work.size == 0) { return; }
+					Region feat("features", false);
+					PerfRegion perfFeat(PERF_FEATURES, true);
+					for (size_t k = 0; k < work.size; k++)
+					{
+						Lpoint& p = points[work.targets[k]];
+						features(work.neigh[k], p);
+						p.part = part;
+					}
+					work.size = 0;
+				};
+
+				chs::QueryStats stats;
+				const auto describe = [&](const size_t q, const auto& results_map) {
+					auto& work = pending[omp_get_thread_num()];
+					if (work.neigh.size() <= work.size)
+					{
+						work.neigh.emplace_back();
+						work.targets.emplace_back();
+					}
+					auto& neigh = work.neigh[work.size];
+					neigh.clear();
+					size_t others = 0; // neighbors but the point itself, the ones the adaptive radius aims at
+					for (auto m : results_map)
+					{
+						if (m->filtered) { continue; }
+						neigh.push_back(Lpoint(m[0][0], m[0][1], m[0][2]));
+						if (m != &points[targets[q]]) { others++; }
+					}
+					work.targets[work.size++] = targets[q];
+					if (work.size == FEATURE_CHUNK) { computeFeatures(work); }
+					return others;
+				};
+
+				if (mainOptions.neighbors > 0)
+				{
+					// radius carried between spatially close points, starting halfway and never beyond the overlap.
+					// Its steps are those of the octree's adaptive searches for a radius of 1
+					const chs::Adaptive adaptive{ .target      = mainOptions.neighbors,
+					                              .min_radius  = rad / 10.0,
+					                              .max_radius  = rad,
+					                              .max_step    = rad / 4.0,
+					                              .sensitivity = rad / 1000.0 };
+					const auto centers = targets | ranges::views::transform([&](const size_t i) -> const Lpoint& {
+						return points[i];
+					});
+					stats = chs::query_adaptive(map, centers, adaptive, rad / 2.0,
+					                    [&](const size_t q, const auto& results_map, const double r) {
+						const size_t used = describe(q, results_map);
+						#pragma omp atomic
+						radsum += r;
+						return used;
+					});
+				}
+				else
+				{
+					const auto spheres = targets | ranges::views::transform([&](const size_t i) {
+						return chs::kernels::Sphere<3>(points[i], rad);
+					});
+					stats = chs::query_batch(map, spheres, describe);
+					radsum += static_cast<double>(rad) * targets.size();
+				}
+				// the last, partial chunk of every thread
+				#pragma omp parallel for schedule(dynamic)
+				for (size_t t = 0; t < pending.size(); t++) { computeFeatures(pending[t]); }
+				perfQuery.stop();
+				const double desc = descriptors.stop();
+				count(QUERIES, stats.queries);
+				count(CELLS_VISITED, stats.cells);
+				count(CANDIDATES_TESTED, stats.candidates);
+				count(NEIGHBORS_FOUND, stats.found);
+
+				std::cout << "Time to calculate descriptors: " << desc << " seconds\n";
+				// debstr += std::to_string(desc) + ", ";
+				desct += desc;
+
+				if (mainOptions.clusterDist > 0)
+				{
+					// labels unique across boxes: the box in the upper half, the first point of the cluster in the lower
+					Region clusters("clusters");
+					// outliers take no part, nor does the overlap beyond rad, whose outliers are not known
+					const auto clustered = [&](const Lpoint& p) {
+						return !p.filtered && (!filtering || !p.overlap || outside(p) <= rad);
+					};
+					const auto labels = chs::euclidean_clusters(map, points, mainOptions.clusterDist, clustered);
+					#pragma omp parallel for
+					for (size_t i = 0; i < points.size(); i++)
+					{
+						points[i].cluster = (static_cast<uint64_t>(part) << 32) | labels[i];
+					}
+					boundaryRecords(points, Box(lboxes[&points - lpoints.data()]), mainOptions.clusterDist, borders);
+					std::cout << "Time to label Euclidean clusters: " << clusters.stop() << " seconds\n";
+				}
+			}, anymap);
 
 			totPoints.insert(totPoints.end(), points.begin(), points.end());
 			part += npes;
 		}
 
+		if (mainOptions.clusterDist > 0)
+		{
+			Region merge("mpi_merge_clusters");
+			const auto joined = mergeClusters(borders);
+			#pragma omp parallel for
+			for (auto& p : totPoints)
+			{
+				if (const auto it = joined.find(p.cluster); it != joined.end()) { p.cluster = it->second; }
+			}
+			std::cout << "Time to merge Euclidean clusters across boxes: " << merge.stop() << " seconds\n";
+		}
+
 		string ext = (mainOptions.zip) ? ".laz" : ".las";
 		fs::path outputFile = mainOptions.outputDirName / (fileName + "_feat" + std::to_string(rank) + ext);
-		tw.start();
+		Region write("write");
+		PerfRegion perfWrite(PERF_WRITE);
 		writePointCloudDescriptors(outputFile, totPoints);
-		tw.stop();
-		std::cout << "Time to write point cloud descriptors: " << tw.getElapsedDecimalSeconds() << " seconds\n";
+		perfWrite.stop();
+		double writet = write.stop();
+		std::cout << "Time to write point cloud descriptors: " << writet << " seconds\n";
+
+		if (mainOptions.npy)
+		{
+			fs::path npyFile = mainOptions.outputDirName / (fileName + "_feat" + std::to_string(rank) + ".npy");
+			Region writeNpy("write_npy");
+			writePointCloudDescriptors(npyFile, totPoints, mainOptions.clusterDist > 0, filtering);
+			std::cout << "Time to write NumPy descriptors: " << writeNpy.stop() << " seconds\n";
+		}
 		
 		fs::path debugFile = mainOptions.outputDirName / (fileName + "_deb.csv");
 		std::ofstream deb;
 		deb.open(debugFile, std::ofstream::app);
 		deb << npes << ", " << rank << ", " << partt << ", " << lboxes.size() << ", " << readt << ", "
 			<< npoints << ", " << nover << ", " << cheeset << ", " << ncells << ", " << nempty << ", "
-			<< desct << ", " << tw.getElapsedDecimalSeconds() << "\n";
+			<< desct << ", " << writet << ", " << maptypes << ", " << cellsizes << ", "
+			<< radsum / std::max<size_t>(npoints - nover - nfiltered, 1) << ", " << nfiltered << ", " << perfColumns() << "\n";
 		deb.close();
 
 		// Global Octree Creation
@@ -223,6 +498,13 @@ int main(int argc, char* argv[])
 		*/
 	}
 
+	// time each rank waits for the slowest one
+	Region wait("mpi_wait_end");
+	MPI_Barrier(MPI_COMM_WORLD);
+	wait.stop();
+	total.stop();
+	writeProfile(mainOptions.outputDirName, fileName);
+
 	MPI_Finalize();
 
 	return EXIT_SUCCESS;
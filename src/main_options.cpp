@@ -16,8 +16,22 @@ void printHelp()
 	       "-o: Path to output file (directory)\n"
 		   "-r: Search radius (default: 0)\n"
 		   "-R: Enable decimation using (total points)/R points\n"
-		   "-s: Cheesemap cell size (default: 1.0)\n"
-		   "-z: Write output to LAZ (default: LAS)\n";
+		   "-s: Cheesemap cell size, or auto to pick it from radius and density (default: 1.0)\n"
+		   "-z: Write output to LAZ (default: LAS)\n"
+		   "--map: Cheesemap type: auto, dense, csr, sparse, mixed3d (default: auto)\n"
+		   "--tune-bench: Refine the automatic cell size timing a sample of queries (implies -s auto)\n"
+		   "--col: Convert the input to the columnar format (.col) in the output directory and read that instead\n"
+		   "--npy: Also write the descriptors as float32 NumPy arrays, one .npy per feature\n"
+		   "--neighbors: Adapt the search radius of each point towards this number of neighbors, -r being the maximum\n"
+		   "--bind: Pin OpenMP threads to CPUs: close, spread (default: not pinned)\n"
+		   "--trace: Also write a Chrome trace of the timed regions of every thread and rank (name_trace.json)\n"
+		   "--perf: Count cycles, instructions, LLC and dTLB misses per phase and append them to the debug CSV\n"
+		   "--index-cache: Save the CSR map of every box to this directory, and map it back on later runs over the same input\n"
+		   "--cluster: Label Euclidean clusters of points closer than this distance, at most -r (cluster.npy with --npy)\n"
+		   "--sor: Leave out points whose neighbor count is this many standard deviations below the mean of their box\n"
+		   "--ror: Leave out points with fewer neighbors than this\n"
+		   "--outlier-radius: Radius the neighbors of --sor and --ror are counted in, at most -r (default: -r). Boxes read\n"
+		   "                  this much more overlap, to judge the overlap points that are neighbors as their own box\n";
 	exit(1);
 }
 
@@ -63,6 +77,12 @@ void processArgs(int argc, char** argv)
 				break;
 			}
 			case 's': {
+				if (std::string(optarg) == "auto")
+				{
+					mainOptions.autoCellSize = true;
+					std::cout << "Cheesemap cell size set to: auto\n";
+					break;
+				}
 				mainOptions.cellSize = std::stof(optarg);
 				std::cout << "Cheesemap cell size set to: " << mainOptions.cellSize << "\n";
 				break;
@@ -72,6 +92,82 @@ void processArgs(int argc, char** argv)
 				std::cout << "Set output to LAZ clouds\n";
 				break;
 			}
+			// Long Options
+			case LongOptions::MAP: {
+				mainOptions.mapType = std::string(optarg);
+				if (mainOptions.mapType != "auto" && mainOptions.mapType != "dense" && mainOptions.mapType != "csr" &&
+				    mainOptions.mapType != "sparse" && mainOptions.mapType != "mixed3d")
+				{
+					printHelp();
+				}
+				std::cout << "Cheesemap type set to: " << mainOptions.mapType << "\n";
+				break;
+			}
+			case LongOptions::TUNE: {
+				mainOptions.autoCellSize = true;
+				mainOptions.tuneBench    = true;
+				std::cout << "Cheesemap cell size set to: auto, benchmarked\n";
+				break;
+			}
+			case LongOptions::COL: {
+				mainOptions.exportCol = true;
+				std::cout << "Input will be converted to the columnar format\n";
+				break;
+			}
+			case LongOptions::NPY: {
+				mainOptions.npy = true;
+				std::cout << "Descriptors will also be written as NumPy arrays\n";
+				break;
+			}
+			case LongOptions::NEIGH: {
+				mainOptions.neighbors = std::stoul(optarg);
+				std::cout << "Adaptive radius targeting " << mainOptions.neighbors << " neighbors\n";
+				break;
+			}
+			case LongOptions::BIND: {
+				mainOptions.bind = std::string(optarg);
+				if (mainOptions.bind != "close" && mainOptions.bind != "spread")
+				{
+					printHelp();
+				}
+				std::cout << "Threads pinned: " << mainOptions.bind << "\n";
+				break;
+			}
+			case LongOptions::TRACE: {
+				mainOptions.trace = true;
+				std::cout << "Timed regions will be traced\n";
+				break;
+			}
+			case LongOptions::PERF: {
+				mainOptions.perf = true;
+				std::cout << "Hardware counters will be collected\n";
+				break;
+			}
+			case LongOptions::CACHE: {
+				mainOptions.indexCache = fs::path(std::string(optarg));
+				std::cout << "Index cache set to: " << mainOptions.indexCache << "\n";
+				break;
+			}
+			case LongOptions::CLUSTER: {
+				mainOptions.clusterDist = std::stof(optarg);
+				std::cout << "Euclidean clustering distance set to: " << mainOptions.clusterDist << "\n";
+				break;
+			}
+			case LongOptions::SOR: {
+				mainOptions.sorRatio = std::stof(optarg);
+				std::cout << "Statistical outlier removal set to: " << mainOptions.sorRatio << " standard deviations\n";
+				break;
+			}
+			case LongOptions::ROR: {
+				mainOptions.rorNeighbors = std::stoul(optarg);
+				std::cout << "Radius outlier removal set to: " << mainOptions.rorNeighbors << " neighbors\n";
+				break;
+			}
+			case LongOptions::OUTRAD: {
+				mainOptions.outlierRadius = std::stof(optarg);
+				std::cout << "Outlier radius set to: " << mainOptions.outlierRadius << "\n";
+				break;
+			}
 			case '?': // Unrecognized option
 			default:
 				printHelp();
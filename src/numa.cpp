@@ -0,0 +1,142 @@
+//
+// NUMA placement of threads and point data
+//
+
+#include "numa.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <linux/mempolicy.h>
+#include <omp.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	// Ids of the NUMA nodes of this machine, which need not be consecutive
+	std::vector<int> nodeIds()
+	{
+		const fs::path nodes = "/sys/devices/system/node";
+		std::vector<int> ids;
+		if (!fs::is_directory(nodes)) { return ids; }
+
+		for (const auto& entry : fs::directory_iterator(nodes))
+		{
+			const auto name = entry.path().filename().string();
+			if (name.size() > 4 && name.compare(0, 4, "node") == 0 && std::isdigit(name[4]))
+			{
+				ids.push_back(std::stoi(name.substr(4)));
+			}
+		}
+		return ids;
+	}
+
+	// CPUs of a NUMA node, from its cpulist ("0-15,32-47")
+	std::vector<int> nodeCpus(int id)
+	{
+		std::ifstream list("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+		std::vector<int> cpus;
+		std::string range;
+		while (std::getline(list, range, ','))
+		{
+			int first = 0, last = 0;
+			char dash = 0;
+			std::istringstream in(range);
+			if (!(in >> first)) { continue; }
+			last = (in >> dash >> last) ? last : first;
+			for (int c = first; c <= last; c++) { cpus.push_back(c); }
+		}
+		return cpus;
+	}
+
+	// NUMA nodes holding any CPU some OpenMP thread of this rank may run on, once they are bound
+	std::vector<int> rankNodeIds()
+	{
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		#pragma omp parallel
+		{
+			cpu_set_t mine;
+			CPU_ZERO(&mine);
+			sched_getaffinity(0, sizeof(mine), &mine);
+			#pragma omp critical
+			CPU_OR(&allowed, &allowed, &mine);
+		}
+
+		std::vector<int> ids;
+		for (const int id : nodeIds())
+		{
+			const auto cpus = nodeCpus(id);
+			if (std::any_of(cpus.begin(), cpus.end(),
+			                [&](int c) { return c < CPU_SETSIZE && CPU_ISSET(c, &allowed); }))
+			{
+				ids.push_back(id);
+			}
+		}
+		return ids;
+	}
+} // namespace
+
+int numaNodes()
+{
+	return std::max(static_cast<int>(nodeIds().size()), 1);
+}
+
+void bindThreads(const std::string& policy, int nodeRank, int nodeSize)
+{
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	sched_getaffinity(0, sizeof(allowed), &allowed);
+
+	std::vector<int> cpus;
+	for (int c = 0; c < CPU_SETSIZE; c++) { if (CPU_ISSET(c, &allowed)) cpus.push_back(c); }
+
+	// Not bound by the launcher, every rank would pin its threads to the same CPUs otherwise
+	if (static_cast<long>(cpus.size()) == sysconf(_SC_NPROCESSORS_ONLN) && nodeSize > 1)
+	{
+		const size_t first = cpus.size() * nodeRank / nodeSize;
+		const size_t last  = cpus.size() * (nodeRank + 1) / nodeSize;
+		cpus = std::vector<int>(cpus.begin() + first, cpus.begin() + last);
+	}
+	if (cpus.empty()) { return; }
+
+	#pragma omp parallel
+	{
+		const size_t t       = omp_get_thread_num();
+		const size_t threads = omp_get_num_threads();
+		const size_t slot    = (policy == "spread") ? t * cpus.size() / threads : t % cpus.size();
+
+		cpu_set_t mine;
+		CPU_ZERO(&mine);
+		CPU_SET(cpus[slot], &mine);
+		sched_setaffinity(0, sizeof(mine), &mine);
+	}
+}
+
+bool interleave(std::vector<Lpoint>& points)
+{
+	// a rank within one node, as one rank per socket, already has its points there from the reader
+	const auto ids = rankNodeIds();
+	if (ids.size() < 2 || points.empty()) { return false; }
+
+	constexpr size_t bits = 8 * sizeof(unsigned long);
+	const int        last = *std::max_element(ids.begin(), ids.end());
+	std::vector<unsigned long> mask(last / bits + 1, 0);
+	for (const int id : ids) { mask[id / bits] |= 1UL << (id % bits); }
+
+	// whole pages, those shared with the neighbours of the vector are only moved too
+	const uintptr_t page  = sysconf(_SC_PAGESIZE);
+	const auto      begin = reinterpret_cast<uintptr_t>(points.data()) & ~(page - 1);
+	const auto      end   = reinterpret_cast<uintptr_t>(points.data() + points.size());
+
+	// the kernel reads one bit less than maxnode
+	return syscall(SYS_mbind, begin, end - begin, MPOL_INTERLEAVE, mask.data(), mask.size() * bits + 1,
+	               MPOL_MF_MOVE) == 0;
+}
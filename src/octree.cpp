@@ -43,6 +43,24 @@ Octree::Octree(Vector center, float radius, std::vector<Lpoint>& points) : cente
 	buildOctree(points);
 }
 
+void Octree::addPoint(Lpoint* p)
+{
+	points_.emplace_back(p);
+	for (size_t i = 0; i < coords_.size(); i++) { coords_[i].emplace_back((*p)[i]); }
+}
+
+void Octree::erasePoint(const size_t i)
+{
+	points_.erase(points_.begin() + i);
+	for (auto& axis : coords_) { axis.erase(axis.begin() + i); }
+}
+
+void Octree::clearPoints()
+{
+	points_.clear();
+	for (auto& axis : coords_) { axis.clear(); }
+}
+
 void Octree::computeOctreeLimits()
 /**
    * Compute the minimum and maximum coordinates of the octree bounding box.
@@ -202,7 +220,7 @@ void Octree::insertPoint(Lpoint* p)
 
 	if (isLeaf())
 	{
-		if (isEmpty()) { points_.emplace_back(p); }
+		if (isEmpty()) { addPoint(p); }
 		else
 		{
 			if (points_.size() > MAX_POINTS && radius_ >= MIN_OCTANT_RADIUS)
@@ -212,7 +230,7 @@ void Octree::insertPoint(Lpoint* p)
 				idx = octantIdx(p);
 				octants_[idx].insertPoint(p);
 			}
-			else { points_.emplace_back(p); }
+			else { addPoint(p); }
 		}
 	}
 	else
@@ -243,7 +261,7 @@ void Octree::fillOctants()
 		octants_[idx].insertPoint(p);
 	}
 
-	points_.clear();
+	clearPoints();
 }
 
 size_t Octree::octantIdx(const Lpoint* p) const
@@ -350,7 +368,7 @@ void Octree::extractPoint(const Lpoint* p)
 	if (isLeaf())
 	{
 		auto index = std::find(points_.begin(), points_.end(), p);
-		if (index != points_.end()) { points_.erase(index); }
+		if (index != points_.end()) { erasePoint(index - points_.begin()); }
 	}
 	else
 	{
@@ -381,7 +399,7 @@ Lpoint* Octree::extractPoint()
 		if (points_.empty()) { return nullptr; }
 
 		auto* p = points_.back();
-		points_.pop_back();
+		erasePoint(points_.size() - 1);
 		return p;
 	}
 
@@ -549,17 +567,12 @@ std::vector<Lpoint*> Octree::extractCloseNeighbors(const Point* p, std::vector<L
 	 * @return
 	 */
 {
-	std::vector<Lpoint*> closeNeighbors;
+	// One pass keeping both sides in order, instead of erasing from the middle for every close neighbor
+	auto close = std::stable_partition(neighbors.begin(), neighbors.end(),
+	                                   [&](const Lpoint* n) { return n->distance3D(*p) > radius; });
 
-	for (size_t i = 0; i < neighbors.size();)
-	{
-		if (neighbors[i]->distance3D(*p) <= radius)
-		{
-			closeNeighbors.push_back(neighbors[i]);
-			neighbors.erase(neighbors.begin() + i);
-		}
-		else { i++; }
-	}
+	std::vector<Lpoint*> closeNeighbors(close, neighbors.end());
+	neighbors.erase(close, neighbors.end());
 
 	return closeNeighbors;
 }
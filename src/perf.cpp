@@ -0,0 +1,158 @@
+//
+// Hardware performance counters per pipeline phase, read with perf_event_open
+//
+
+#include "perf.hpp"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <linux/perf_event.h>
+#include <omp.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+	struct EventConfig
+	{
+		uint32_t type;
+		uint64_t config;
+	};
+
+	constexpr uint64_t readMisses(uint64_t cache)
+	{
+		return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	}
+
+	const EventConfig events[PERF_EVENT_COUNT] = { { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		                                           { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		                                           { PERF_TYPE_HW_CACHE, readMisses(PERF_COUNT_HW_CACHE_LL) },
+		                                           { PERF_TYPE_HW_CACHE, readMisses(PERF_COUNT_HW_CACHE_DTLB) } };
+
+	// Counters of one thread, in a group so that one read gets all of them at the same time
+	struct ThreadGroup
+	{
+		int              leader{ -1 };
+		int              fds[PERF_EVENT_COUNT]{ -1, -1, -1, -1 };
+		std::vector<int> order; // event of each value of the group, in opening order
+	};
+
+	std::vector<ThreadGroup>           groups; // by OpenMP thread number
+	std::array<bool, PERF_EVENT_COUNT> available{};
+
+	// Counts are scaled by the time each group was scheduled when the PMU is multiplexed, hence doubles
+	std::array<std::array<std::atomic<double>, PERF_EVENT_COUNT>, PERF_PHASE_COUNT> totals{};
+
+	int openEvent(const EventConfig& event, int leader)
+	{
+		perf_event_attr attr{};
+		attr.size           = sizeof(attr);
+		attr.type           = event.type;
+		attr.config         = event.config;
+		attr.disabled       = leader == -1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv     = 1;
+		attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		// calling thread, any CPU
+		return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+	}
+
+	/**
+	 * @brief Adds the current counts of a thread to values
+	 */
+	void readGroup(const ThreadGroup& group, double* values)
+	{
+		if (group.leader == -1) { return; }
+
+		// nr, time enabled, time running, then one value per event
+		uint64_t buf[3 + PERF_EVENT_COUNT];
+		if (read(group.leader, buf, sizeof(buf)) < static_cast<ssize_t>(3 * sizeof(uint64_t))) { return; }
+
+		const double scale = buf[2] ? static_cast<double>(buf[1]) / static_cast<double>(buf[2]) : 0;
+		for (size_t i = 0; i < buf[0] && i < group.order.size(); i++)
+		{
+			values[group.order[i]] += static_cast<double>(buf[3 + i]) * scale;
+		}
+	}
+
+	void readCounters(bool thread, double* values)
+	{
+		if (!thread)
+		{
+			for (const auto& group : groups) { readGroup(group, values); }
+			return;
+		}
+		const auto t = static_cast<size_t>(omp_get_thread_num());
+		if (t < groups.size()) { readGroup(groups[t], values); }
+	}
+} // namespace
+
+bool enablePerf()
+{
+	groups.resize(omp_get_max_threads());
+
+	#pragma omp parallel
+	{
+		const auto t = static_cast<size_t>(omp_get_thread_num());
+		if (t < groups.size())
+		{
+			ThreadGroup& group = groups[t];
+			for (int e = 0; e < PERF_EVENT_COUNT; e++)
+			{
+				group.fds[e] = openEvent(events[e], group.leader);
+				if (group.fds[e] == -1) { continue; }
+				if (group.leader == -1) { group.leader = group.fds[e]; }
+				group.order.push_back(e);
+			}
+			if (group.leader != -1) { ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP); }
+		}
+	}
+
+	// Only events counted on every thread are reported
+	bool any = false;
+	for (int e = 0; e < PERF_EVENT_COUNT; e++)
+	{
+		available[e] = true;
+		for (const auto& group : groups) { available[e] = available[e] && group.fds[e] != -1; }
+		any = any || available[e];
+	}
+
+	PerfRegion::perfEnabled = any;
+	return any;
+}
+
+void PerfRegion::begin()
+{
+	readCounters(thread_, start_);
+	open_ = true;
+}
+
+void PerfRegion::end()
+{
+	open_ = false;
+
+	double now[PERF_EVENT_COUNT]{};
+	readCounters(thread_, now);
+	for (int e = 0; e < PERF_EVENT_COUNT; e++) { totals[phase_][e].fetch_add(now[e] - start_[e]); }
+}
+
+std::string perfColumns()
+{
+	std::string columns;
+	for (int p = 0; p < PERF_PHASE_COUNT; p++)
+	{
+		for (int e = 0; e < PERF_EVENT_COUNT; e++)
+		{
+			double value = totals[p][e].load();
+			// the query phase encloses the features computed on the fly
+			if (p == PERF_QUERY) { value -= totals[PERF_FEATURES][e].load(); }
+
+			columns += columns.empty() ? "" : ", ";
+			columns += PerfRegion::perfEnabled && available[e] ? std::to_string(std::llround(value)) : "-1";
+		}
+	}
+	return columns;
+}
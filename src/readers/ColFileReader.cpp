@@ -0,0 +1,180 @@
+//
+// Reader of the columnar binary point cloud format (.col)
+//
+
+#include "ColFileReader.hpp"
+#include "ColFormat.hpp"
+#include "MappedFile.hpp"
+#include <cstring>
+#include <random>
+
+/**
+ * @brief Columns of a mapped .col file, used in place
+ */
+struct ColView
+{
+	const ColHeader* header{};
+	const ColTile*   tiles{};
+	const char*      base{};
+
+	template<typename T>
+	[[nodiscard]] const T* col(ColColumn c) const
+	{
+		return reinterpret_cast<const T*>(base + header->offsets[c]);
+	}
+};
+
+/**
+ * @brief Whether the tiles and columns the header describes lie within the file, so that a truncated or corrupted
+ * file is rejected before anything is read through them
+ */
+bool colFits(const ColView& view, size_t size)
+{
+	const auto& h = *view.header;
+	if (size < sizeof(ColHeader) + static_cast<uint64_t>(h.numTiles) * sizeof(ColTile)) return false;
+
+	for (size_t c = 0; c < COL_COUNT; c++)
+	{
+		// checked one by one, so that no product or sum can overflow
+		if (h.offsets[c] > size || h.offsets[c] % COL_WIDTH[c] != 0) return false;
+		if (h.numPoints > (size - h.offsets[c]) / COL_WIDTH[c]) return false;
+	}
+
+	for (size_t t = 0; t < h.numTiles; t++)
+	{
+		if (view.tiles[t].first > h.numPoints || view.tiles[t].count > h.numPoints - view.tiles[t].first) return false;
+	}
+
+	return true;
+}
+
+ColView colView(const MappedFile& file)
+{
+	const auto text = file.view();
+
+	ColView view;
+	view.base   = text.data();
+	view.header = reinterpret_cast<const ColHeader*>(view.base);
+
+	if (text.size() < sizeof(ColHeader) || std::memcmp(view.header->magic, COL_MAGIC, sizeof(COL_MAGIC)) != 0 ||
+	    view.header->version != COL_VERSION)
+	{
+		std::cout << "Unrecognized format\n";
+		exit(1);
+	}
+
+	view.tiles = reinterpret_cast<const ColTile*>(view.base + sizeof(ColHeader));
+	if (!colFits(view, text.size()))
+	{
+		std::cout << "Truncated or corrupted columnar file\n";
+		exit(1);
+	}
+
+	return view;
+}
+
+Lpoint colPoint(const ColView& v, size_t i)
+{
+	return Lpoint(v.col<uint32_t>(COL_ID)[i], v.col<double>(COL_X)[i], v.col<double>(COL_Y)[i],
+	              v.col<double>(COL_Z)[i], v.col<float>(COL_I)[i], v.col<uint8_t>(COL_RN)[i],
+	              v.col<uint8_t>(COL_NOR)[i], v.col<uint8_t>(COL_DIR)[i], v.col<uint8_t>(COL_EDGE)[i],
+	              v.col<uint8_t>(COL_CLASS)[i], v.col<int8_t>(COL_SAR)[i], v.col<uint8_t>(COL_UD)[i],
+	              v.col<uint16_t>(COL_PSID)[i], v.col<uint16_t>(COL_R)[i], v.col<uint16_t>(COL_G)[i],
+	              v.col<uint16_t>(COL_B)[i]);
+}
+
+bool tileIntersects(const ColTile& tile, const Box& box)
+{
+	return tile.min[0] <= box.maxX() && tile.max[0] >= box.minX() && tile.min[1] <= box.maxY() &&
+	       tile.max[1] >= box.minY() && tile.min[2] <= box.maxZ() && tile.max[2] >= box.minZ();
+}
+
+std::vector<Lpoint> ColFileReader::read()
+{
+	MappedFile file(path);
+	const auto view = colView(file);
+
+	std::vector<Lpoint> points(view.header->numPoints);
+
+	#pragma omp parallel for
+	for (size_t i = 0; i < points.size(); i++) { points[i] = colPoint(view, i); }
+
+	std::cout << "Read points: " << points.size() << "\n";
+	return points;
+}
+
+std::vector<Lpoint> ColFileReader::decRead(int jump, float percent)
+{
+	MappedFile file(path);
+	const auto view = colView(file);
+
+	static std::default_random_engine e;
+	static std::uniform_real_distribution<> dis(0, 1); // [0,1)
+
+	std::vector<Lpoint> points;
+	for (size_t i = 0; i < view.header->numPoints; i += jump)
+	{
+		if (dis(e) <= percent) { points.push_back(colPoint(view, i)); }
+	}
+
+	return points;
+}
+
+std::vector<Lpoint> ColFileReader::readOverlap(const Box& box, const Box& overlap)
+{
+	return readOverlap(std::vector<Box>{ box }, std::vector<Box>{ overlap })[0];
+}
+
+std::vector<std::vector<Lpoint>> ColFileReader::readOverlap(const std::vector<Box>& boxes, const std::vector<Box>& overlaps)
+{
+	MappedFile file(path);
+	const auto view     = colView(file);
+	const auto numTiles = view.header->numTiles;
+
+	const double* x = view.col<double>(COL_X);
+	const double* y = view.col<double>(COL_Y);
+	const double* z = view.col<double>(COL_Z);
+
+	// Points of each overlap found in each tile, only the tiles intersecting an overlap are visited
+	std::vector<std::vector<std::vector<Lpoint>>> partial(numTiles, std::vector<std::vector<Lpoint>>(overlaps.size()));
+
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t t = 0; t < numTiles; t++)
+	{
+		const ColTile& tile = view.tiles[t];
+		for (size_t b = 0; b < overlaps.size(); b++)
+		{
+			if (!tileIntersects(tile, overlaps[b])) continue;
+
+			for (size_t i = tile.first; i < tile.first + tile.count; i++)
+			{
+				const Point p(x[i], y[i], z[i]);
+				if (overlaps[b].isInside(p))
+				{
+					partial[t][b].push_back(colPoint(view, i));
+					partial[t][b].back().overlap = !boxes[b].isInside(p);
+				}
+			}
+		}
+	}
+
+	std::vector<std::vector<Lpoint>> points(overlaps.size());
+	for (size_t b = 0; b < overlaps.size(); b++)
+	{
+		for (size_t t = 0; t < numTiles; t++)
+		{
+			points[b].insert(points[b].end(), partial[t][b].begin(), partial[t][b].end());
+		}
+	}
+
+	return points;
+}
+
+std::pair<Point, Point> ColFileReader::readBoundingBox()
+{
+	MappedFile file(path);
+	const auto view = colView(file);
+	const auto& h   = *view.header;
+
+	return std::make_pair(Point{ h.min[0], h.min[1], h.min[2] }, Point{ h.max[0], h.max[1], h.max[2] });
+}
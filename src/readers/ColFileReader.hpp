@@ -0,0 +1,52 @@
+//
+// Reader of the columnar binary point cloud format (.col)
+//
+
+#pragma once
+
+#include "FileReader.hpp"
+#include "Lpoint.hpp"
+#include "Box.hpp"
+
+/**
+ * @brief Specialization of FileReader to read .col files. The file is mapped into memory and the points are built
+ * straight from its columns; box-filtered reads only visit the tiles that intersect the boxes.
+ */
+class ColFileReader : public FileReader
+{
+	public:
+	// ***  CONSTRUCTION / DESTRUCTION  *** //
+	// ************************************ //
+	ColFileReader(const fs::path& path) : FileReader(path){};
+	~ColFileReader(){};
+
+	/**
+	 * @brief Reads the points contained in the .col file
+	 * @return Vector of Lpoint
+	 */
+	std::vector<Lpoint> read();
+
+	/**
+	 * @brief Read 1 in every jump points contained in the .col file, keeping each with probability percent
+	 * @return Vector of Lpoint
+	 */
+	std::vector<Lpoint> decRead(int jump, float percent);
+
+	/**
+	 * @brief Reads the points of the .col file inside overlap, flagging those outside box
+	 * @return Vector of Lpoint
+	 */
+	std::vector<Lpoint> readOverlap(const Box& box, const Box& overlap);
+
+	/**
+	 * @brief Reads the points of the .col file inside each of the overlaps, flagging those outside the matching box
+	 * @return Vector of Lpoint per box
+	 */
+	std::vector<std::vector<Lpoint>> readOverlap(const std::vector<Box>& boxes, const std::vector<Box>& overlaps);
+
+	/**
+	 * @brief Reads the bounding box stored in the header of the .col file
+	 * @return Pair of min and max coordinates
+	 */
+	std::pair<Point, Point> readBoundingBox();
+};
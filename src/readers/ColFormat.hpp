@@ -0,0 +1,62 @@
+//
+// Layout of the columnar binary point cloud format (.col)
+//
+
+/*
+ * A .col file is a ColHeader, followed by numTiles ColTile entries, followed by one array per column. Points are
+ * sorted by tile, so the points of tile t are entries [first, first + count) of every column. Columns are aligned to
+ * COL_ALIGNMENT bytes from the start of the file so they can be used in place once the file is mapped.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr char     COL_MAGIC[8]  = { 'T', 'F', 'M', 'C', 'O', 'L', '\0', '\0' };
+constexpr uint32_t COL_VERSION   = 1;
+constexpr size_t   COL_ALIGNMENT = 64;
+constexpr size_t   COL_TILE_SIZE = 1 << 16; // points per tile, on average
+
+enum ColColumn : uint32_t
+{
+	COL_ID = 0, // uint32_t
+	COL_X,      // double
+	COL_Y,      // double
+	COL_Z,      // double
+	COL_I,      // float
+	COL_RN,     // uint8_t
+	COL_NOR,    // uint8_t
+	COL_DIR,    // uint8_t
+	COL_EDGE,   // uint8_t
+	COL_CLASS,  // uint8_t
+	COL_SAR,    // int8_t
+	COL_UD,     // uint8_t
+	COL_PSID,   // uint16_t
+	COL_R,      // uint16_t
+	COL_G,      // uint16_t
+	COL_B,      // uint16_t
+	COL_COUNT
+};
+
+// Bytes per entry of each column
+constexpr size_t COL_WIDTH[COL_COUNT] = { 4, 8, 8, 8, 4, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2 };
+
+struct ColHeader
+{
+	char     magic[8];
+	uint32_t version;
+	uint32_t numTiles;
+	uint64_t numPoints;
+	double   min[3];
+	double   max[3];
+	uint64_t offsets[COL_COUNT]; // byte offset of each column from the start of the file
+};
+
+struct ColTile
+{
+	double   min[3];
+	double   max[3];
+	uint64_t first;
+	uint64_t count;
+};
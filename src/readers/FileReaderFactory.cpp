@@ -8,6 +8,7 @@ File_t chooseReaderType(const std::string& fExt)
 {
 	if (fExt == ".las" || fExt == ".laz") return las_t;
 	if (fExt == ".txt" || fExt == ".xyz") return txt_t;
+	if (fExt == ".col") return col_t;
 
 	return err_t;
 }
\ No newline at end of file
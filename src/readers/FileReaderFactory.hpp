@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "ColFileReader.hpp"
 #include "FileType.hpp"
 #include "LasFileReader.hpp"
 #include "TxtFileReader.hpp"
@@ -35,6 +36,8 @@ class FileReaderFactory
 				return std::make_shared<TxtFileReader>(path);
 			case las_t:
 				return std::make_shared<LasFileReader>(path);
+			case col_t:
+				return std::make_shared<ColFileReader>(path);
 			default:
 				std::cout << "Unable to create specialized FileReader\n";
 				exit(-2);
@@ -9,5 +9,7 @@ enum File_t
 {
     txt_t,  // txt type
     las_t,  // las type
+    col_t,  // columnar binary type
+    npy_t,  // numpy arrays type (write only)
     err_t   // error type (no compatible extensions were found)
 };
\ No newline at end of file
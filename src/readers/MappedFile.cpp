@@ -0,0 +1,54 @@
+//
+// Read-only memory mapping of a whole file
+//
+
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <sys/mman.h>
+
+#include "cheesemap/utils/mapped_file.hpp"
+
+MappedFile::MappedFile(const fs::path& path)
+{
+	std::error_code error;
+	const auto      size = fs::file_size(path, error);
+	if (error)
+	{
+		std::cout << "Unable to open " << path << "\n";
+		exit(1);
+	}
+	if (size == 0) { return; } // nothing to map, parsed as an empty view
+
+	file_ = chs::MappedFile::open(path);
+	if (not file_)
+	{
+		std::cout << "Unable to map " << path << " into memory\n";
+		exit(1);
+	}
+	data_ = reinterpret_cast<const char*>(file_->data());
+	size_ = file_->size();
+	madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile() = default;
+
+std::vector<std::string_view> MappedFile::lineChunks(size_t n) const
+{
+	std::vector<std::string_view> chunks;
+	const auto text = view();
+
+	size_t begin = 0;
+	for (size_t c = 1; c <= n && begin < text.size(); c++)
+	{
+		size_t end = (c == n) ? text.size() : std::max(begin, text.size() * c / n);
+		end        = (end < text.size()) ? text.find('\n', end) : text.size();
+		end        = (end == std::string_view::npos) ? text.size() : end + 1;
+
+		chunks.push_back(text.substr(begin, end - begin));
+		begin = end;
+	}
+
+	return chunks;
+}
@@ -0,0 +1,45 @@
+//
+// Read-only memory mapping of a whole file
+//
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace chs
+{
+class MappedFile;
+}
+
+/**
+ * @brief Maps a file read-only into memory for the lifetime of the object, so it can be parsed in place. Shares the
+ * mapping of the cheesemap library, adding the checks and line splitting the readers need
+ */
+class MappedFile
+{
+	std::shared_ptr<const chs::MappedFile> file_;
+	const char*                            data_{};
+	size_t                                 size_{};
+
+	public:
+	// ***  CONSTRUCTION / DESTRUCTION  *** //
+	// ************************************ //
+	explicit MappedFile(const fs::path& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&)            = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	[[nodiscard]] std::string_view view() const { return { data_, size_ }; }
+
+	/**
+	 * @brief Splits the file in up to n chunks of similar size, each ending right after a newline (or at the end of
+	 * the file), so that they can be parsed independently
+	 */
+	[[nodiscard]] std::vector<std::string_view> lineChunks(size_t n) const;
+};
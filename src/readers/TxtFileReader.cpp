@@ -3,148 +3,251 @@
 //
 
 #include "TxtFileReader.hpp"
+#include "MappedFile.hpp"
 #include "main_options.hpp"
-#include <fstream>
-#include <iterator>
+#include <algorithm>
+#include <charconv>
+#include <omp.h>
+#include <random>
 
-std::vector<std::string> splitLine(std::string& line)
+// Most columns a line can have, extra ones are ignored
+constexpr size_t MAX_COLS = 64;
+
+size_t parseLine(const char*& it, const char* end, double* fields, size_t maxCols)
 {
-	std::istringstream                 buf(line);
-	std::istream_iterator<std::string> beg(buf), end;
-	std::vector<std::string>           tokens(beg, end);
+	size_t n = 0;
+	while (it < end && *it != '\n')
+	{
+		if (*it == ' ' || *it == '\t' || *it == '\r' || *it == ',')
+		{
+			it++;
+			continue;
+		}
+		if (n == maxCols) break;
+
+		if (*it == '+') it++; // not accepted by from_chars
+		auto [ptr, ec] = std::from_chars(it, end, fields[n]);
+		if (ec != std::errc())
+		{
+			n = 0; // malformed line, skipped
+			break;
+		}
+		it = ptr;
+		n++;
+	}
 
-	return tokens;
+	while (it < end && *it++ != '\n') {}
+	return n;
 }
 
-void TxtFileReader::setNumberOfColumns(std::ifstream& file)
+Lpoint txtPoint(unsigned int idx, const double* f, uint8_t numCols)
 {
-	std::string line, item;
-
-	std::getline(file, line);
-	file.seekg(0); // Return to first line to be read later.
-	std::stringstream ss(line);
-
-	numCols = 0;
-	while (ss >> item)
-		numCols++;
+	switch (numCols)
+	{
+		case 3:
+			return Lpoint(idx, f[0], f[1], f[2]); // id, x, y, z
+		case 7:
+			// id, x, y, z, I, rn, nor, classification
+			return Lpoint(idx, f[0], f[1], f[2], f[3], f[4], f[5], static_cast<int>(f[6]));
+		// Raw point cloud without RGB
+		case 9:
+			// id, x, y, z, I, rn, nor, dir, edge, classification
+			return Lpoint(idx, f[0], f[1], f[2], f[3], static_cast<int>(f[4]), static_cast<int>(f[5]),
+			              static_cast<int>(f[6]), static_cast<int>(f[7]), static_cast<int>(f[8]));
+		default:
+			// id, x, y, z, I, rn, nor, dir, edge, classification, r, g, b
+			return Lpoint(idx, f[0], f[1], f[2], f[3], static_cast<int>(f[4]), static_cast<int>(f[5]),
+			              static_cast<int>(f[6]), static_cast<int>(f[7]), static_cast<int>(f[8]),
+			              static_cast<int>(f[9]), static_cast<int>(f[10]), static_cast<int>(f[11]));
+	}
 }
 
-std::vector<Lpoint> TxtFileReader::read()
+// Size of the chunks of decRead(), fixed so that the sample does not depend on the number of threads
+constexpr size_t DEC_CHUNK_BYTES = size_t{ 4 } << 20;
+
+/**
+ * @brief Parses the newline-aligned chunks of the file in parallel. Every point is handed to
+ * route(point, chunk, line, outs) along with the chunk index, its line in the chunk (blank and malformed lines
+ * counted) and the chunk's own outputs, to be pushed to any of them or dropped. Points get their number among the
+ * points of the file as id, and the outputs of all chunks are concatenated in file order.
+ */
+template<typename Route>
+std::vector<std::vector<Lpoint>> parseChunks(const std::vector<std::string_view>& chunks, uint8_t numCols, size_t nOuts,
+                                             Route&& route)
 {
-	std::ifstream file(path.string());
-	std::string   line{};
+	std::vector<std::vector<std::vector<Lpoint>>> partial(chunks.size(), std::vector<std::vector<Lpoint>>(nOuts));
+	std::vector<unsigned int> lines(chunks.size() + 1, 0);
 
-	setNumberOfColumns(file);
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t c = 0; c < chunks.size(); c++)
+	{
+		const char* it  = chunks[c].data();
+		const char* end = it + chunks[c].size();
+		double fields[MAX_COLS];
+
+		unsigned int line = 0;
+		for (size_t physical = 0; it < end; physical++)
+		{
+			if (parseLine(it, end, fields, numCols) < numCols) continue; // blank or malformed
+			Lpoint p = txtPoint(line++, fields, numCols);
+			route(p, c, physical, partial[c]);
+		}
+		lines[c + 1] = line;
+	}
 
-	unsigned int        idx = 0;
-	std::vector<Lpoint> points;
+	// Ids so far are relative to the chunk
+	for (size_t c = 0; c < chunks.size(); c++) { lines[c + 1] += lines[c]; }
 
-	// TODO: Pensar como modularizarlo...
-	// TODO: Factory as a function of the number of columns to read different inputs!
-	switch (numCols)
+	std::vector<std::vector<Lpoint>> points(nOuts);
+	for (size_t o = 0; o < nOuts; o++)
 	{
-		case 3:
-			while (std::getline(file, line, '\n'))
+		std::vector<size_t> starts(chunks.size() + 1, 0);
+		for (size_t c = 0; c < chunks.size(); c++) { starts[c + 1] = starts[c] + partial[c][o].size(); }
+		points[o].resize(starts.back());
+
+		#pragma omp parallel for schedule(dynamic)
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			for (size_t i = 0; i < partial[c][o].size(); i++)
 			{
-				auto tokens = splitLine(line);
-				points.emplace_back(idx++,                 // id
-				                    std::stod(tokens[0]),  // x
-				                    std::stod(tokens[1]),  // y
-				                    std::stod(tokens[2])); // z
+				Lpoint& p = points[o][starts[c] + i];
+				p         = std::move(partial[c][o][i]);
+				p.id(p.id() + lines[c]);
 			}
-			break;
+			std::vector<Lpoint>().swap(partial[c][o]);
+		}
+	}
 
-		case 7:
-			while (std::getline(file, line, '\n'))
-			{
-				auto tokens = splitLine(line);
-				points.emplace_back(idx++,                 // id
-				                    std::stod(tokens[0]),  // x
-				                    std::stod(tokens[1]),  // y
-				                    std::stod(tokens[2]),  // z
-				                    std::stod(tokens[3]),  // I
-				                    std::stod(tokens[4]),  // rn
-				                    std::stod(tokens[5]),  // nor
-				                    std::stoi(tokens[6])); // classification
-			}
-			break;
+	return points;
+}
 
-		// Raw point cloud without RGB
-		case 9:
-			while (std::getline(file, line, '\n'))
-			{
-				auto tokens = splitLine(line);
-				points.emplace_back(idx++,                 // id
-				                    std::stod(tokens[0]),  // x
-				                    std::stod(tokens[1]),  // y
-				                    std::stod(tokens[2]),  // z
-				                    std::stod(tokens[3]),  // I
-				                    std::stoi(tokens[4]),  // rn
-				                    std::stoi(tokens[5]),  // nor
-				                    std::stoi(tokens[6]),  // dir
-				                    std::stoi(tokens[7]),  // edge
-				                    std::stoi(tokens[8])); // classification
-			}
-			break;
+void TxtFileReader::setNumberOfColumns(std::string_view text)
+{
+	const char* it = text.data();
+	double fields[MAX_COLS];
 
-		case 12:
-			while (std::getline(file, line, '\n'))
-			{
-				auto tokens = splitLine(line);
-				points.emplace_back(idx++,                  // id
-				                    std::stod(tokens[0]),   // x
-				                    std::stod(tokens[1]),   // y
-				                    std::stod(tokens[2]),   // z
-				                    std::stod(tokens[3]),   // I
-				                    std::stoi(tokens[4]),   // rn
-				                    std::stoi(tokens[5]),   // nor
-				                    std::stoi(tokens[6]),   // dir
-				                    std::stoi(tokens[7]),   // edge
-				                    std::stoi(tokens[8]),   // classification
-				                    std::stoi(tokens[9]),   // r
-				                    std::stoi(tokens[10]),  // g
-				                    std::stoi(tokens[11])); // b
-			}
-			break;
+	numCols = parseLine(it, text.data() + text.size(), fields, MAX_COLS);
+}
 
-		default:
-			std::cout << "Unrecognized format\n";
-			exit(1);
+void TxtFileReader::setFormat(const MappedFile& file)
+{
+	setNumberOfColumns(file.view());
+
+	if (numCols != 3 && numCols != 7 && numCols != 9 && numCols != 12)
+	{
+		std::cout << "Unrecognized format\n";
+		exit(1);
 	}
-	file.close();
-	std::cout << "Read points: " << idx << "\n";
+}
+
+std::vector<Lpoint> TxtFileReader::read()
+{
+	MappedFile file(path);
+	setFormat(file);
+
+	const auto chunks = file.lineChunks(4 * omp_get_max_threads());
+	auto points = std::move(parseChunks(chunks, numCols, 1, [](Lpoint& p, size_t, size_t, auto& outs) {
+		outs[0].push_back(std::move(p));
+	})[0]);
+
+	std::cout << "Read points: " << points.size() << "\n";
 	return points;
 };
 
 std::vector<Lpoint> TxtFileReader::decRead(int jump, float percent)
 {
+	MappedFile file(path);
+	setFormat(file);
+
+	// Chunks of a fixed size, each with a generator seeded with its offset in the file, so the sample depends on the
+	// file alone and not on the number of threads or their schedule
+	const auto text   = file.view();
+	const auto chunks = file.lineChunks(std::max<size_t>(1, text.size() / DEC_CHUNK_BYTES));
+	std::vector<std::default_random_engine> engines;
+	for (const auto& chunk : chunks) { engines.emplace_back(chunk.data() - text.data()); }
+
+	// Line of the file each chunk starts at, so that the jump counts lines of the whole file
+	std::vector<size_t> firstLine(chunks.size() + 1, 0);
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t c = 0; c < chunks.size(); c++)
+	{
+		firstLine[c + 1] = std::count(chunks[c].begin(), chunks[c].end(), '\n');
+	}
+	for (size_t c = 0; c < chunks.size(); c++) { firstLine[c + 1] += firstLine[c]; }
+
+	// 1 in every jump lines of the file, then each of those with probability percent
+	auto points = std::move(parseChunks(chunks, numCols, 1, [&](Lpoint& p, size_t c, size_t line, auto& outs) {
+		if ((firstLine[c] + line) % jump) return;
+		std::uniform_real_distribution<> dis(0, 1); // [0,1)
+		if (dis(engines[c]) <= percent) { outs[0].push_back(std::move(p)); }
+	})[0]);
+
+	return points;
 }
 
 std::vector<Lpoint> TxtFileReader::readOverlap(const Box& box, const Box& overlap)
 {
+	MappedFile file(path);
+	setFormat(file);
+
+	const auto chunks = file.lineChunks(4 * omp_get_max_threads());
+	auto points = std::move(parseChunks(chunks, numCols, 1, [&](Lpoint& p, size_t, size_t, auto& outs) {
+		if (overlap.isInside(p))
+		{
+			p.overlap = !box.isInside(p);
+			outs[0].push_back(std::move(p));
+		}
+	})[0]);
+
+	return points;
 }
 
 std::vector<std::vector<Lpoint>> TxtFileReader::readOverlap(const std::vector<Box>& boxes, const std::vector<Box>& overlaps)
 {
+	MappedFile file(path);
+	setFormat(file);
+
+	// points can be saved more than once, not great memory-wise
+	const auto chunks = file.lineChunks(4 * omp_get_max_threads());
+	return parseChunks(chunks, numCols, boxes.size(), [&](Lpoint& p, size_t, size_t, auto& outs) {
+		for (size_t i = 0; i < overlaps.size(); i++)
+		{
+			if (overlaps[i].isInside(p))
+			{
+				outs[i].push_back(p);
+				outs[i].back().overlap = !boxes[i].isInside(p);
+			}
+		}
+	});
 }
 
 std::pair<Point, Point> TxtFileReader::readBoundingBox()
 {
 	double x_min = __DBL_MAX__, y_min = __DBL_MAX__, z_min = __DBL_MAX__;
 	double x_max = -__DBL_MAX__, y_max = -__DBL_MAX__, z_max = -__DBL_MAX__;
-	std::ifstream file(path.string());
-	std::string   line{};
 
-	while (std::getline(file, line, '\n'))
+	MappedFile file(path);
+	const auto chunks = file.lineChunks(4 * omp_get_max_threads());
+
+	// Only the coordinates are parsed, the rest of each line is skipped
+	#pragma omp parallel for schedule(dynamic) reduction(min:x_min, y_min, z_min) reduction(max:x_max, y_max, z_max)
+	for (size_t c = 0; c < chunks.size(); c++)
 	{
-		auto tokens = splitLine(line);
-		if (std::stod(tokens[0]) < x_min) x_min = std::stod(tokens[0]);
-		if (std::stod(tokens[1]) < y_min) y_min = std::stod(tokens[1]);
-		if (std::stod(tokens[2]) < z_min) z_min = std::stod(tokens[2]);
-		if (std::stod(tokens[0]) > x_max) x_max = std::stod(tokens[0]);
-		if (std::stod(tokens[1]) > y_max) y_max = std::stod(tokens[1]);
-		if (std::stod(tokens[2]) > z_max) z_max = std::stod(tokens[2]);
+		const char* it  = chunks[c].data();
+		const char* end = it + chunks[c].size();
+		double xyz[3];
+
+		while (it < end)
+		{
+			if (parseLine(it, end, xyz, 3) < 3) continue;
+			x_min = std::min(x_min, xyz[0]);
+			y_min = std::min(y_min, xyz[1]);
+			z_min = std::min(z_min, xyz[2]);
+			x_max = std::max(x_max, xyz[0]);
+			y_max = std::max(y_max, xyz[1]);
+			z_max = std::max(z_max, xyz[2]);
+		}
 	}
 
 	return std::make_pair(Point{x_min, y_min, z_min}, Point{x_max, y_max, z_max});
-}
\ No newline at end of file
+}
@@ -5,6 +5,10 @@
 #pragma once
 
 #include "FileReader.hpp"
+#include <string_view>
+
+class MappedFile;
+
 /**
  * @brief Specialization of FileRead to read .txt/.xyz files
  */
@@ -19,34 +23,39 @@ class TxtFileReader : public FileReader
 	~TxtFileReader(){};
 
 	/**
-	 * @brief Reads the points contained in the .txt/.xyz file
+	 * @brief Reads the points contained in the .txt/.xyz file, mapping it into memory and parsing it in parallel
 	 * @return Vector of Lpoint
 	 */
 	std::vector<Lpoint> read();
 
 	/**
-	 * @brief Read 1 in every jump points contained in the .txt/.xyz file
+	 * @brief Read 1 in every jump points contained in the .txt/.xyz file, keeping each with probability percent
 	 * @return Vector of Lpoint
 	 */
-	[[deprecated("not yet implemented")]] std::vector<Lpoint> decRead(int jump, float percent);
+	std::vector<Lpoint> decRead(int jump, float percent);
 
 	/**
-	 * @brief Sets the number of columns of the file to be read
-	 * @return Number of columns of the file
+	 * @brief Sets the number of columns of the file to be read, counting the fields of its first line
 	 */
-	void setNumberOfColumns(std::ifstream& file);
+	void setNumberOfColumns(std::string_view text);
 
 	/**
-	 * @brief Reads the points contained in the .txt/.xyz file
+	 * @brief Sets the number of columns of the mapped file, exiting if it is not a supported layout
+	 */
+	void setFormat(const MappedFile& file);
+
+	/**
+	 * @brief Reads the points of the .txt/.xyz file inside overlap, flagging those outside box
 	 * @return Vector of Lpoint
 	 */
-	[[deprecated("not yet implemented")]] std::vector<Lpoint> readOverlap(const Box& box, const Box& overlap);
+	std::vector<Lpoint> readOverlap(const Box& box, const Box& overlap);
 	
 	/**
-	 * @brief Reads the points contained in the .txt/.xyz file
-	 * @return Vector of Lpoint
+	 * @brief Reads the points of the .txt/.xyz file inside each of the overlaps in a single pass, flagging those
+	 * outside the matching box
+	 * @return Vector of Lpoint per box
 	 */
-	[[deprecated("not yet implemented")]] std::vector<std::vector<Lpoint>> readOverlap(const std::vector<Box>& boxes, const std::vector<Box>& overlaps);
+	std::vector<std::vector<Lpoint>> readOverlap(const std::vector<Box>& boxes, const std::vector<Box>& overlaps);
 
 	/**
 	 * @brief Reads the bounding box of the .txt/.xyz file
@@ -54,5 +63,3 @@ class TxtFileReader : public FileReader
 	 */
 	std::pair<Point, Point> readBoundingBox();
 };
-
-std::vector<std::string> splitLine(std::string& line);
\ No newline at end of file
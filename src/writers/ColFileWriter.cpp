@@ -0,0 +1,136 @@
+//
+// Writer of the columnar binary point cloud format (.col)
+//
+
+#include "ColFileWriter.hpp"
+#include "ColFormat.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+template<typename T, typename Get>
+void writeColumn(std::ofstream& out, uint64_t offset, const std::vector<const Lpoint*>& sorted, Get&& get)
+{
+    // Padding up to the aligned start of the column
+    const std::vector<char> zeros(offset - static_cast<uint64_t>(out.tellp()), 0);
+    out.write(zeros.data(), zeros.size());
+
+    std::vector<T> column(sorted.size());
+    #pragma omp parallel for
+    for (size_t i = 0; i < sorted.size(); i++) { column[i] = static_cast<T>(get(*sorted[i])); }
+    out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+void ColFileWriter::write(std::vector<Lpoint>& points)
+{
+    std::vector<const Lpoint*> kept;
+    for (const Lpoint& p : points)
+    {
+        if (p.overlap) continue;
+        kept.push_back(&p);
+    }
+    const size_t n = kept.size();
+
+    ColHeader header{};
+    std::memcpy(header.magic, COL_MAGIC, sizeof(COL_MAGIC));
+    header.version   = COL_VERSION;
+    header.numPoints = n;
+    for (int d = 0; d < 3; d++)
+    {
+        header.min[d] = n ? __DBL_MAX__ : 0;
+        header.max[d] = n ? -__DBL_MAX__ : 0;
+    }
+    for (const Lpoint* p : kept)
+    {
+        for (int d = 0; d < 3; d++)
+        {
+            header.min[d] = std::min(header.min[d], (*p)[d]);
+            header.max[d] = std::max(header.max[d], (*p)[d]);
+        }
+    }
+
+    // Square grid of tiles over XY, COL_TILE_SIZE points each on average
+    const size_t side = std::max<size_t>(1, std::ceil(std::sqrt(static_cast<double>(n) / COL_TILE_SIZE)));
+    auto tileOf = [&](const Lpoint& p) {
+        size_t t[2];
+        for (int d = 0; d < 2; d++)
+        {
+            const double extent = header.max[d] - header.min[d];
+            t[d] = extent > 0 ? std::min(side - 1, static_cast<size_t>((p[d] - header.min[d]) / extent * side)) : 0;
+        }
+        return t[0] * side + t[1];
+    };
+
+    // Counting sort of the points by tile
+    std::vector<size_t> starts(side * side + 1, 0);
+    for (const Lpoint* p : kept) { starts[tileOf(*p) + 1]++; }
+    for (size_t t = 0; t < side * side; t++) { starts[t + 1] += starts[t]; }
+
+    std::vector<const Lpoint*> sorted(n);
+    std::vector<size_t>        cursor(starts.begin(), starts.end() - 1);
+    for (const Lpoint* p : kept) { sorted[cursor[tileOf(*p)]++] = p; }
+
+    // Empty tiles are not stored
+    std::vector<ColTile> tiles;
+    for (size_t t = 0; t < side * side; t++)
+    {
+        if (starts[t] == starts[t + 1]) continue;
+
+        ColTile tile{};
+        tile.first = starts[t];
+        tile.count = starts[t + 1] - starts[t];
+        for (int d = 0; d < 3; d++)
+        {
+            tile.min[d] = __DBL_MAX__;
+            tile.max[d] = -__DBL_MAX__;
+        }
+        for (size_t i = starts[t]; i < starts[t + 1]; i++)
+        {
+            for (int d = 0; d < 3; d++)
+            {
+                tile.min[d] = std::min(tile.min[d], (*sorted[i])[d]);
+                tile.max[d] = std::max(tile.max[d], (*sorted[i])[d]);
+            }
+        }
+        tiles.push_back(tile);
+    }
+    header.numTiles = tiles.size();
+
+    uint64_t offset = sizeof(ColHeader) + tiles.size() * sizeof(ColTile);
+    for (uint32_t c = 0; c < COL_COUNT; c++)
+    {
+        offset            = (offset + COL_ALIGNMENT - 1) / COL_ALIGNMENT * COL_ALIGNMENT;
+        header.offsets[c] = offset;
+        offset += n * COL_WIDTH[c];
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(tiles.data()), tiles.size() * sizeof(ColTile));
+
+    const auto& off = header.offsets;
+    writeColumn<uint32_t>(out, off[COL_ID], sorted, [](const Lpoint& p) { return p.id(); });
+    writeColumn<double>(out, off[COL_X], sorted, [](const Lpoint& p) { return p.getX(); });
+    writeColumn<double>(out, off[COL_Y], sorted, [](const Lpoint& p) { return p.getY(); });
+    writeColumn<double>(out, off[COL_Z], sorted, [](const Lpoint& p) { return p.getZ(); });
+    writeColumn<float>(out, off[COL_I], sorted, [](const Lpoint& p) { return p.getI(); });
+    writeColumn<uint8_t>(out, off[COL_RN], sorted, [](const Lpoint& p) { return p.rn(); });
+    writeColumn<uint8_t>(out, off[COL_NOR], sorted, [](const Lpoint& p) { return p.nor(); });
+    writeColumn<uint8_t>(out, off[COL_DIR], sorted, [](const Lpoint& p) { return p.dir(); });
+    writeColumn<uint8_t>(out, off[COL_EDGE], sorted, [](const Lpoint& p) { return p.edge(); });
+    writeColumn<uint8_t>(out, off[COL_CLASS], sorted, [](const Lpoint& p) { return p.getClass(); });
+    writeColumn<int8_t>(out, off[COL_SAR], sorted, [](const Lpoint& p) { return p.sar(); });
+    writeColumn<uint8_t>(out, off[COL_UD], sorted, [](const Lpoint& p) { return p.ud(); });
+    writeColumn<uint16_t>(out, off[COL_PSID], sorted, [](const Lpoint& p) { return p.psId(); });
+    writeColumn<uint16_t>(out, off[COL_R], sorted, [](const Lpoint& p) { return p.getR(); });
+    writeColumn<uint16_t>(out, off[COL_G], sorted, [](const Lpoint& p) { return p.getG(); });
+    writeColumn<uint16_t>(out, off[COL_B], sorted, [](const Lpoint& p) { return p.getB(); });
+
+    out.close();
+}
+
+void ColFileWriter::writeDescriptors(std::vector<Lpoint>& points)
+{
+    write(points);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "FileWriter.hpp"
+#include "Lpoint.hpp"
+
+/**
+ * @brief Writes points to the columnar binary format (.col), grouped in tiles so that readers can load only the
+ * tiles they need
+ */
+class ColFileWriter : public FileWriter
+{
+    public:
+    ColFileWriter(const fs::path& path) : FileWriter(path){};
+    ~ColFileWriter(){};
+
+    /**
+     * @brief Writes the points to a .col file
+     */
+    void write(std::vector<Lpoint>& points);
+
+    /**
+     * @brief The .col format only holds the point records, so this writes the points alone
+     */
+    void writeDescriptors(std::vector<Lpoint>& points);
+};
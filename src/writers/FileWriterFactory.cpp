@@ -4,6 +4,8 @@ File_t chooseWriterType(const std::string& fExt)
 {
     if (fExt == ".las" || fExt == ".laz") return las_t;
     if (fExt == ".txt" || fExt == ".xyz") return txt_t;
+    if (fExt == ".col") return col_t;
+    if (fExt == ".npy") return npy_t;
 
     return err_t;
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "ColFileWriter.hpp"
 #include "FileType.hpp"
 #include "LasFileWriter.hpp"
+#include "NpyFileWriter.hpp"
 #include "TxtFileWriter.hpp"
 #include <filesystem>
 
@@ -12,7 +14,9 @@ File_t chooseWriterType(const std::string& fExt);
 class FileWriterFactory
 {
     public:
-    static std::shared_ptr<FileWriter> makeWriter(File_t type, const fs::path& path)
+    // clusters and filtered only matter to the writers of labels, see NpyFileWriter
+    static std::shared_ptr<FileWriter> makeWriter(File_t type, const fs::path& path, bool clusters = false,
+                                                  bool filtered = false)
     {
         switch (type)
         {
@@ -20,6 +24,10 @@ class FileWriterFactory
             return std::make_shared<TxtFileWriter>(path);
         case las_t:
             return std::make_shared<LasFileWriter>(path);
+        case col_t:
+            return std::make_shared<ColFileWriter>(path);
+        case npy_t:
+            return std::make_shared<NpyFileWriter>(path, clusters, filtered);
         default:
             std::cout << "Unable to create specialized FileWriter\n";
             exit(-2);
@@ -0,0 +1,126 @@
+//
+// Writer of point clouds and their descriptors as NumPy arrays (.npy), one file per column
+//
+
+#include "NpyFileWriter.hpp"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+template<typename T>
+constexpr const char* npyDescr()
+{
+    if constexpr (std::is_same_v<T, uint8_t>) return "|u1";
+    else if constexpr (std::is_same_v<T, uint16_t>) return "<u2";
+    else if constexpr (std::is_same_v<T, uint32_t>) return "<u4";
+    else if constexpr (std::is_same_v<T, uint64_t>) return "<u8";
+    else if constexpr (std::is_same_v<T, float>) return "<f4";
+    else return "<f8";
+}
+
+/**
+ * @brief Writes get(p) of every point to a version 1.0 .npy file
+ */
+template<typename T, typename Get>
+void writeNpy(const fs::path& file, const std::vector<const Lpoint*>& points, Get&& get)
+{
+    std::string dict = std::string("{'descr': '") + npyDescr<T>() + "', 'fortran_order': False, 'shape': (" +
+                       std::to_string(points.size()) + ",), }";
+
+    // magic, version and header length take 10 bytes, the data must start 64-byte aligned
+    dict.append(63 - (10 + dict.size()) % 64, ' ');
+    dict += '\n';
+    const uint16_t len = dict.size();
+
+    std::vector<T> column(points.size());
+    for (size_t i = 0; i < points.size(); i++) { column[i] = static_cast<T>(get(*points[i])); }
+
+    std::ofstream out(file, std::ios::binary);
+    out.write("\x93NUMPY\x01\x00", 8);
+    out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+    out.write(dict.data(), dict.size());
+    out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+    out.close();
+}
+
+/**
+ * @brief Writes the given columns to their own files in parallel
+ */
+void writeColumns(const std::vector<std::function<void()>>& columns)
+{
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < columns.size(); c++) { columns[c](); }
+}
+
+std::vector<const Lpoint*> keptPoints(const std::vector<Lpoint>& points)
+{
+    std::vector<const Lpoint*> kept;
+    for (const Lpoint& p : points)
+    {
+        if (p.overlap) continue;
+        kept.push_back(&p);
+    }
+    return kept;
+}
+
+void NpyFileWriter::write(std::vector<Lpoint>& points)
+{
+    const fs::path dir = fs::path(path).replace_extension();
+    fs::create_directories(dir);
+    const auto kept = keptPoints(points);
+
+    writeColumns({
+        [&] { writeNpy<uint32_t>(dir / "id.npy", kept, [](const Lpoint& p) { return p.id(); }); },
+        [&] { writeNpy<double>(dir / "x.npy", kept, [](const Lpoint& p) { return p.getX(); }); },
+        [&] { writeNpy<double>(dir / "y.npy", kept, [](const Lpoint& p) { return p.getY(); }); },
+        [&] { writeNpy<double>(dir / "z.npy", kept, [](const Lpoint& p) { return p.getZ(); }); },
+    });
+}
+
+void NpyFileWriter::writeDescriptors(std::vector<Lpoint>& points)
+{
+    const fs::path dir = fs::path(path).replace_extension();
+    fs::create_directories(dir);
+    const auto kept = keptPoints(points);
+
+    // Coordinates stay in double, float32 loses centimetres on projected coordinates
+    std::vector<std::function<void()>> columns{
+        [&] { writeNpy<uint32_t>(dir / "id.npy", kept, [](const Lpoint& p) { return p.id(); }); },
+        [&] { writeNpy<double>(dir / "x.npy", kept, [](const Lpoint& p) { return p.getX(); }); },
+        [&] { writeNpy<double>(dir / "y.npy", kept, [](const Lpoint& p) { return p.getY(); }); },
+        [&] { writeNpy<double>(dir / "z.npy", kept, [](const Lpoint& p) { return p.getZ(); }); },
+        [&] { writeNpy<float>(dir / "neighbors.npy", kept, [](const Lpoint& p) { return p.nNeigh; }); },
+        [&] { writeNpy<float>(dir / "sum.npy", kept, [](const Lpoint& p) { return p.sum; }); },
+        [&] { writeNpy<float>(dir / "omnivariance.npy", kept, [](const Lpoint& p) { return p.omnivar; }); },
+        [&] { writeNpy<float>(dir / "eigenentropy.npy", kept, [](const Lpoint& p) { return p.eigenen; }); },
+        [&] { writeNpy<float>(dir / "linearity.npy", kept, [](const Lpoint& p) { return p.linear; }); },
+        [&] { writeNpy<float>(dir / "planarity.npy", kept, [](const Lpoint& p) { return p.planar; }); },
+        [&] { writeNpy<float>(dir / "sphericity.npy", kept, [](const Lpoint& p) { return p.spheric; }); },
+        [&] { writeNpy<float>(dir / "curvature_change.npy", kept, [](const Lpoint& p) { return p.curvChange; }); },
+        [&] { writeNpy<float>(dir / "verticality_0.npy", kept, [](const Lpoint& p) { return p.vert[0]; }); },
+        [&] { writeNpy<float>(dir / "verticality_1.npy", kept, [](const Lpoint& p) { return p.vert[1]; }); },
+        [&] { writeNpy<float>(dir / "absolute_moment_0.npy", kept, [](const Lpoint& p) { return p.absMom[0]; }); },
+        [&] { writeNpy<float>(dir / "absolute_moment_1.npy", kept, [](const Lpoint& p) { return p.absMom[1]; }); },
+        [&] { writeNpy<float>(dir / "absolute_moment_2.npy", kept, [](const Lpoint& p) { return p.absMom[2]; }); },
+        [&] { writeNpy<float>(dir / "absolute_moment_3.npy", kept, [](const Lpoint& p) { return p.absMom[3]; }); },
+        [&] { writeNpy<float>(dir / "absolute_moment_4.npy", kept, [](const Lpoint& p) { return p.absMom[4]; }); },
+        [&] { writeNpy<float>(dir / "absolute_moment_5.npy", kept, [](const Lpoint& p) { return p.absMom[5]; }); },
+        [&] { writeNpy<float>(dir / "vertical_moment_0.npy", kept, [](const Lpoint& p) { return p.vertMom[0]; }); },
+        [&] { writeNpy<float>(dir / "vertical_moment_1.npy", kept, [](const Lpoint& p) { return p.vertMom[1]; }); },
+        [&] { writeNpy<uint16_t>(dir / "partition.npy", kept, [](const Lpoint& p) { return p.part; }); },
+    };
+    // labels only exist when clustering or filtering, but then they are always written, so every box has them
+    if (clusters)
+    {
+        columns.emplace_back(
+                [&] { writeNpy<uint64_t>(dir / "cluster.npy", kept, [](const Lpoint& p) { return p.cluster; }); });
+    }
+    if (filtered)
+    {
+        columns.emplace_back(
+                [&] { writeNpy<uint8_t>(dir / "filtered.npy", kept, [](const Lpoint& p) { return p.filtered; }); });
+    }
+    writeColumns(columns);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "FileWriter.hpp"
+#include "Lpoint.hpp"
+
+/**
+ * @brief Writes points as NumPy arrays, one .npy file per column inside a directory named after the output path
+ * without its extension (out/cloud_feat0.npy -> out/cloud_feat0/x.npy, ...), so they can be loaded with
+ * numpy.load(..., mmap_mode='r'). Rows of every column belong to the same point.
+ */
+class NpyFileWriter : public FileWriter
+{
+    bool clusters{};
+    bool filtered{};
+
+    public:
+    /**
+     * @brief The descriptors include cluster.npy if clusters, and filtered.npy if filtered
+     */
+    NpyFileWriter(const fs::path& path, bool clusters = false, bool filtered = false) :
+        FileWriter(path), clusters(clusters), filtered(filtered){};
+    ~NpyFileWriter(){};
+
+    /**
+     * @brief Writes the ids and coordinates of the points
+     */
+    void write(std::vector<Lpoint>& points);
+
+    /**
+     * @brief Writes the ids, coordinates and descriptors of the points, descriptors as float32
+     */
+    void writeDescriptors(std::vector<Lpoint>& points);
+};
@@ -24,17 +24,17 @@ void TxtFileWriter::writeDescriptors(std::vector<Lpoint>& points)
     out << std::fixed << std::setprecision(2);
 
     // header with column names
-    out << "X Y Z numberNeighbors SumEigenValues Omnivariane Eigenentropy"
-            "Linearity Planarity Sphericity CurvatureChange Verticality1"
-            "Verticality2 AbsoluteMoment1 AbsoluteMoment2 AbsoluteMoment3"
-            "AbsoluteMoment4 AbsoluteMoment5 AbsoluteMoment6 VerticalMoment1"
-            "VerticalMoment2";
+    out << "X Y Z numberNeighbors SumEigenValues Omnivariance Eigenentropy "
+            "Linearity Planarity Sphericity CurvatureChange Verticality1 "
+            "Verticality2 AbsoluteMoment1 AbsoluteMoment2 AbsoluteMoment3 "
+            "AbsoluteMoment4 AbsoluteMoment5 AbsoluteMoment6 VerticalMoment1 "
+            "VerticalMoment2\n";
 
     for (const Lpoint& p : points)
     {
         if (p.overlap) continue;
         out << p.getX() << " " << p.getY() << " " << p.getZ() << " "
-        << p.nNeigh << " " << p.omnivar << " " << p.eigenen << " "
+        << p.nNeigh << " " << p.sum << " " << p.omnivar << " " << p.eigenen << " "
         << p.linear << " " << p.planar << " " << p.spheric << " "
         << p.curvChange << " " << p.vert[0] << " " << p.vert[1] << " "
         << p.absMom[0] << " " << p.absMom[1] << " " << p.absMom[2] << " "